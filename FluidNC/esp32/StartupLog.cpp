@@ -2,55 +2,173 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "src/StartupLog.h"
-#include "src/Protocol.h"  // send_line()
+#include "src/LogRing.h"
+#include "src/Protocol.h"        // send_line()
+#include "esp32-hal.h"  // RTC_NOINIT_ATTR, esp_reset_reason()
+#include <esp_timer.h>   // esp_timer_get_time()
 #include <sstream>
 
 // The startup log is stored in RTC RAM that is preserved across
 // resets.  That lets us show the previous startup log if the
-// system panics and resets.
+// system panics, or the watchdog or brownout detector resets it.
+// After such a reset the new messages are appended, and once the
+// ring is full they replace the oldest ones.
 
 // The size is limited by the size of RTC RAM minus system usage thereof
-static const size_t           _maxlen = 7000;
-static RTC_NOINIT_ATTR char   _messages[_maxlen];
-static RTC_NOINIT_ATTR size_t _len;
-static bool                   _paniced;
+static const size_t             _maxlen = 5600;
+static const uint32_t           _magic  = 0x474f4c53;  // "SLOG"
+static RTC_NOINIT_ATTR char     _messages[_maxlen];
+static RTC_NOINIT_ATTR size_t   _len;  // Total bytes written, so the ring index is _len % _maxlen
+static RTC_NOINIT_ATTR uint32_t _ring_magic;
+static esp_reset_reason_t       _reset_reason;
+static bool                     _continued;
+static LogRing                  _ring(_messages, _maxlen, _len);
+
+// The time of each boot stage, for this boot and the one before
+static const size_t max_stages = 32;
+struct BootStage {
+    char     name[16];
+    uint32_t usecs;
+};
+struct BootTiming {
+    uint32_t  magic;
+    uint32_t  n_stages;
+    uint32_t  finished;
+    BootStage stages[max_stages];
+
+    bool     valid() const { return magic == _magic && n_stages <= max_stages; }
+    uint32_t msecs() const {
+        uint32_t usecs = 0;
+        for (size_t i = 0; i < n_stages; i++) {
+            usecs += stages[i].usecs;
+        }
+        return usecs / 1000;
+    }
+    // The time of stage i of another boot, if this boot had that stage
+    const BootStage* match(const BootStage& other, size_t i) const {
+        return i < n_stages && !strcmp(stages[i].name, other.name) ? &stages[i] : nullptr;
+    }
+};
+static RTC_NOINIT_ATTR BootTiming _boots[2];
+static BootTiming&                _current  = _boots[0];
+static BootTiming&                _previous = _boots[1];
+static int64_t                    _stage_start;  // Microseconds since boot, which does not wrap
+
+static const char* reset_name(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_PANIC:
+            return "panic";
+        case ESP_RST_INT_WDT:
+            return "interrupt watchdog";
+        case ESP_RST_TASK_WDT:
+            return "task watchdog";
+        case ESP_RST_WDT:
+            return "watchdog";
+        case ESP_RST_BROWNOUT:
+            return "brownout";
+        default:
+            return nullptr;
+    }
+}
 
 void StartupLog::init() {
-    if (esp_reset_reason() == ESP_RST_PANIC) {
-        _paniced = true;
+    _stage_start = esp_timer_get_time();
+
+    _reset_reason = esp_reset_reason();
+    auto reason   = reset_name(_reset_reason);
+    _continued    = reason && _ring_magic == _magic && _len;
+    if (_continued) {
+        _ring.append("[MSG:WARN: Restarted after ");
+        _ring.append(reason);
+        _ring.append(" reset]\n");
     } else {
-        _paniced = false;
-        _len     = 0;
+        _ring_magic = _magic;
+        _len        = 0;
     }
+
+    if (_current.valid()) {
+        _previous = _current;
+    } else {
+        _previous.magic = 0;
+    }
+    _current.magic    = _magic;
+    _current.n_stages = 0;
+    _current.finished = false;
 }
-size_t StartupLog::write(uint8_t data) {
-    if (_paniced || _len >= _maxlen) {
-        return 0;
+
+void StartupLog::stage(const char* name) {
+    int64_t  now   = esp_timer_get_time();
+    uint32_t usecs = uint32_t(now - _stage_start);
+    _stage_start   = now;
+
+    if (_current.n_stages == max_stages) {
+        // Fold the later stages into the last one
+        _current.stages[max_stages - 1].usecs += usecs;
+        return;
+    }
+    auto& stage = _current.stages[_current.n_stages];
+    strncpy(stage.name, name, sizeof(stage.name) - 1);
+    stage.name[sizeof(stage.name) - 1] = '\0';
+    stage.usecs                        = usecs;
+    ++_current.n_stages;
+}
+
+void StartupLog::finish() {
+    _current.finished = true;
+
+    if (atMsgLevel(MsgLevelInfo)) {
+        LogStream msg(MsgLevelInfo, "[MSG:INFO: Startup msecs");
+        for (size_t i = 0; i < _current.n_stages; i++) {
+            auto& stage = _current.stages[i];
+            if (auto ms = stage.usecs / 1000) {
+                msg << ' ' << stage.name << ':' << static_cast<unsigned int>(ms);
+            }
+        }
+        msg << " total:" << static_cast<unsigned int>(_current.msecs());
+        if (_previous.valid()) {
+            msg << " previous:" << static_cast<unsigned int>(_previous.msecs());
+        }
     }
-    _messages[_len++] = (char)data;
+
+    if (_previous.valid() && !_previous.finished) {
+        // The stage after the last one it finished is where it stopped
+        size_t n    = _previous.n_stages;
+        auto   last = n ? _previous.stages[n - 1].name : "start";
+        auto   next = n < _current.n_stages ? _current.stages[n].name : "?";
+        log_warn("Previous startup did not finish, it stopped in " << next << " after " << last << " at "
+                                                                   << static_cast<unsigned int>(_previous.msecs()) << " msecs");
+    }
+}
+
+size_t StartupLog::write(uint8_t data) {
+    _ring.put(char(data));
     return 1;
 }
+
 // cppcheck-suppress unusedFunction
 void StartupLog::dump(Channel& out) {
-    if (_paniced) {
-        log_error_to(out, "Showing startup log from previous panic");
-    }
-    for (size_t i = 0; i < _len;) {
-        std::string line;
-        while (i < _len) {
-            char c = _messages[i++];
-            if (c == '\r') {
-                continue;
-            }
-            if (c == '\n') {
-                break;
-            }
-            line += c;
-        }
+    if (_continued) {
+        log_warn_to(out, "Startup log includes the boot before the " << reset_name(_reset_reason) << " reset");
+    }
+    _ring.lines([&](std::string& line) {
         if (!line.empty() && line.back() == ']') {
             line.pop_back();
         }
         log_stream(out, line);
+    });
+
+    // Each stage of this boot next to the same stage of the previous one
+    for (size_t i = 0; i < _current.n_stages; i++) {
+        auto& stage = _current.stages[i];
+        auto  prev  = _previous.valid() ? _previous.match(stage, i) : nullptr;
+        if (prev) {
+            log_info_to(out, "Startup stage " << stage.name << " usecs " << static_cast<unsigned int>(stage.usecs) << " previous "
+                                              << static_cast<unsigned int>(prev->usecs));
+        } else if (_previous.valid() && !_previous.finished && i == _previous.n_stages) {
+            log_info_to(out, "Startup stage " << stage.name << " usecs " << static_cast<unsigned int>(stage.usecs) << " previous stopped here");
+        } else {
+            log_info_to(out, "Startup stage " << stage.name << " usecs " << static_cast<unsigned int>(stage.usecs));
+        }
     }
 }
 
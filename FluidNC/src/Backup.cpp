@@ -0,0 +1,436 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Backup.h"
+
+#include "Lzss.h"
+#include "FileStream.h"
+#include "HashFS.h"
+#include "Settings.h"
+#include "SettingsDefinitions.h"  // config_filename
+#include "Machine/Macros.h"       // Macros::files()
+
+#include <mbedtls/md.h>
+#include <algorithm>
+#include <memory>
+#include <new>
+
+struct BundleHeader {
+    char    magic[4];
+    uint8_t version;
+    uint8_t reserved[3];
+};
+
+static const char    bundle_magic[4] = { 'F', 'N', 'C', 'B' };
+static const uint8_t bundle_version  = 1;
+static const size_t  digest_size     = 32;  // SHA-256
+static const size_t  record_head     = 6;
+static const size_t  max_value       = 1024;  // For settings and coordinate systems
+
+enum class RecordType : uint8_t {
+    End          = 'E',
+    ConfigFile   = 'C',
+    MacroFile    = 'F',
+    SettingValue = 'S',
+    CoordOffsets = 'O',
+};
+
+// SHA-256 of the bundle, computed as HashFS does for files
+class BundleDigest {
+    mbedtls_md_context_t _ctx;
+
+public:
+    BundleDigest() {
+        mbedtls_md_init(&_ctx);
+        mbedtls_md_setup(&_ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0);
+        mbedtls_md_starts(&_ctx);
+    }
+    ~BundleDigest() { mbedtls_md_free(&_ctx); }
+
+    void update(const uint8_t* data, size_t length) { mbedtls_md_update(&_ctx, data, length); }
+    void finish(uint8_t* digest) { mbedtls_md_finish(&_ctx, digest); }
+};
+
+static void record(LzssEncoder& encoder, RecordType type, const std::string& name, uint32_t length) {
+    uint8_t head[record_head] = {
+        uint8_t(type), uint8_t(name.length()), uint8_t(length), uint8_t(length >> 8), uint8_t(length >> 16), uint8_t(length >> 24)
+    };
+    encoder.write(head, sizeof(head));
+    encoder.write((const uint8_t*)name.data(), name.length());
+}
+
+static void record(LzssEncoder& encoder, RecordType type, const std::string& name, const void* data, uint32_t length) {
+    record(encoder, type, name, length);
+    encoder.write((const uint8_t*)data, length);
+}
+
+// Copies a file into the bundle a piece at a time
+static bool add_file(LzssEncoder& encoder, RecordType type, const std::string& name, Channel& out) {
+    std::unique_ptr<FileStream> file;
+    if (name.length() > 255) {
+        log_warn_to(out, "Backup skips " << name << ", the name is too long");
+        return false;
+    }
+    try {
+        file = std::make_unique<FileStream>(name, "r", "");
+    } catch (...) {
+        log_warn_to(out, "Backup cannot read " << name);
+        return false;
+    }
+    uint32_t remaining = file->size();
+    record(encoder, type, name, remaining);
+    uint8_t buf[256];
+    while (remaining) {
+        size_t len = file->read(buf, std::min(remaining, uint32_t(sizeof(buf))));
+        if (len == 0) {
+            // The record length is already in the bundle
+            throw Error::FsFailedRead;
+        }
+        encoder.write(buf, len);
+        remaining -= len;
+    }
+    return true;
+}
+
+// The bundle must not replace a file that it backs up
+static bool is_backed_up(const FluidPath& fpath, const std::vector<std::string>& macro_files) {
+    std::error_code ec;
+    FluidPath       config_path { config_filename->get(), "", ec };
+    if (!ec && config_path.string() == fpath.string()) {
+        return true;
+    }
+    return std::find(macro_files.begin(), macro_files.end(), fpath.string()) != macro_files.end();
+}
+
+Error Backup::save(const char* path, Channel& out) {
+    std::error_code ec;
+    FluidPath       fpath { path, "", ec };
+    if (ec) {
+        return Error::FsFailedOpenFile;
+    }
+    auto macro_files = Machine::Macros::files(out);
+    if (is_backed_up(fpath, macro_files)) {
+        log_error_to(out, "Backup cannot replace " << fpath.c_str() << ", which it backs up");
+        return Error::InvalidValue;
+    }
+
+    // The bundle is written under a temporary name, so a failed backup
+    // leaves any earlier bundle as it was
+    std::string                 temp = std::string(path) + ".tmp";
+    std::unique_ptr<FileStream> bundle;
+    try {
+        bundle = std::make_unique<FileStream>(temp, "w", "");
+    } catch (Error err) { return err; }
+
+    size_t       files = 0, settings = 0, offsets = 0;
+    BundleDigest digest;
+    auto         emit = [&](const uint8_t* data, size_t length) {
+        bundle->write(data, length);
+        digest.update(data, length);
+    };
+    try {
+        BundleHeader header = {};
+        memcpy(header.magic, bundle_magic, sizeof(header.magic));
+        header.version = bundle_version;
+        emit((const uint8_t*)&header, sizeof(header));
+
+        LzssEncoder encoder(emit);
+        if (add_file(encoder, RecordType::ConfigFile, config_filename->get(), out)) {
+            ++files;
+        }
+        for (auto const& name : macro_files) {
+            if (add_file(encoder, RecordType::MacroFile, name, out)) {
+                ++files;
+            }
+        }
+        // Like $SC, the settings that differ from their defaults.  Passwords
+        // always read as their default, so they are never in the bundle.
+        for (Setting* s : Setting::List) {
+            const char* value = s->getStringValue();
+            if (s->getType() != PIN && strcmp(value, s->getDefaultString())) {
+                record(encoder, RecordType::SettingValue, s->getName(), value, strlen(value));
+                ++settings;
+            }
+        }
+        for (auto coord : coords) {
+            record(encoder, RecordType::CoordOffsets, coord->getName(), coord->get(), MAX_N_AXIS * sizeof(float));
+            ++offsets;
+        }
+        record(encoder, RecordType::End, "", nullptr, 0);
+        encoder.finish();
+    } catch (Error err) {
+        auto temp_path = bundle->fpath();
+        bundle.reset();
+        stdfs::remove(temp_path, ec);
+        return err;
+    } catch (const std::bad_alloc&) {
+        // The encoder needs about 32 KiB
+        log_error_to(out, "Not enough memory for a backup");
+        auto temp_path = bundle->fpath();
+        bundle.reset();
+        stdfs::remove(temp_path, ec);
+        return Error::FsFailedCreateFile;
+    }
+
+    uint8_t sum[digest_size];
+    digest.finish(sum);
+    bundle->write(sum, sizeof(sum));
+    size_t size      = bundle->position();
+    auto   temp_path = bundle->fpath();
+    bundle.reset();
+
+    // FAT cannot rename onto an existing file
+    stdfs::remove(fpath, ec);
+    stdfs::rename(temp_path, fpath, ec);
+    if (ec) {
+        stdfs::remove(temp_path, ec);
+        return Error::FsFailedRenameFile;
+    }
+    HashFS::rehash_file(fpath);
+    log_info_to(out,
+                "Backup " << path << " has " << files << " files, " << settings << " settings and " << offsets << " coordinate systems in "
+                          << size << " bytes");
+    return Error::Ok;
+}
+
+// Takes the records apart as the decoder produces them.  Unless apply is
+// true, it only checks that the records are well formed.
+class BundleReader {
+    enum State { Head, Name, Data, Done };
+
+    bool     _apply;
+    Channel& _out;
+
+    State       _state = Head;
+    uint8_t     _head[record_head];
+    size_t      _got = 0;
+    RecordType  _type;
+    size_t      _name_len;
+    std::string _name;
+    uint32_t    _remaining;
+    std::string _value;  // The data of a setting or coordinate system
+
+    std::unique_ptr<FileStream> _file;
+
+    bool _bad = false;
+
+    void begin();
+    void end();
+
+public:
+    size_t _files    = 0;
+    size_t _settings = 0;
+    size_t _offsets  = 0;
+    size_t _failed   = 0;
+    bool   _config   = false;
+
+    BundleReader(bool apply, Channel& out) : _apply(apply), _out(out) {}
+
+    void write(const uint8_t* data, size_t length);
+    bool ok() { return !_bad && _state == Done; }
+};
+
+void BundleReader::write(const uint8_t* data, size_t length) {
+    while (length && !_bad) {
+        size_t n;
+        switch (_state) {
+            case Head:
+                n = std::min(length, record_head - _got);
+                memcpy(_head + _got, data, n);
+                _got += n;
+                if (_got == record_head) {
+                    _got       = 0;
+                    _type      = RecordType(_head[0]);
+                    _name_len  = _head[1];
+                    _remaining = _head[2] | (_head[3] << 8) | (_head[4] << 16) | (uint32_t(_head[5]) << 24);
+                    _name.clear();
+                    _state = Name;
+                    if (!_name_len) {
+                        begin();
+                    }
+                }
+                break;
+            case Name:
+                n = std::min(length, _name_len - _name.length());
+                _name.append((const char*)data, n);
+                if (_name.length() == _name_len) {
+                    begin();
+                }
+                break;
+            case Data:
+                n = std::min(length, size_t(_remaining));
+                if (_type == RecordType::SettingValue || _type == RecordType::CoordOffsets) {
+                    _value.append((const char*)data, n);
+                } else if (_file) {
+                    _file->write(data, n);
+                }
+                _remaining -= n;
+                if (!_remaining) {
+                    end();
+                }
+                break;
+            case Done:
+            default:
+                // Nothing may follow the end record
+                _bad = true;
+                return;
+        }
+        data += n;
+        length -= n;
+    }
+}
+
+// Starts a record once its name is known
+void BundleReader::begin() {
+    _state = Data;
+    _value.clear();
+    switch (_type) {
+        case RecordType::End:
+            _bad   = _remaining != 0;
+            _state = Done;
+            return;
+        case RecordType::SettingValue:
+        case RecordType::CoordOffsets:
+            if (_remaining > max_value) {
+                _bad = true;
+                return;
+            }
+            break;
+        case RecordType::ConfigFile:
+        case RecordType::MacroFile:
+            if (_apply) {
+                try {
+                    _file = std::make_unique<FileStream>(_name, "w", "");
+                } catch (...) {
+                    log_warn_to(_out, "Restore cannot write " << _name);
+                    ++_failed;
+                }
+            }
+            break;
+        default:
+            _bad = true;
+            return;
+    }
+    if (!_remaining) {
+        end();
+    }
+}
+
+// Applies a record once all of its data is in
+void BundleReader::end() {
+    _state = Head;
+    if (!_apply) {
+        return;
+    }
+    switch (_type) {
+        case RecordType::ConfigFile:
+        case RecordType::MacroFile:
+            if (_file) {
+                auto fpath = _file->fpath();
+                _file.reset();
+                HashFS::rehash_file(fpath);
+                ++_files;
+                _config = _config || _type == RecordType::ConfigFile;
+            }
+            break;
+        case RecordType::SettingValue: {
+            Setting* setting = nullptr;
+            for (Setting* s : Setting::List) {
+                if (!strcasecmp(s->getName(), _name.c_str())) {
+                    setting = s;
+                    break;
+                }
+            }
+            Error err = setting ? setting->setStringValue(_value) : Error::InvalidStatement;
+            if (err == Error::Ok) {
+                ++_settings;
+            } else if (err != Error::ReadOnlySetting) {
+                // Read-only settings show values from the configuration file
+                log_warn_to(_out, "Restore cannot set $" << _name << "=" << _value << ": " << errorString(err));
+                ++_failed;
+            }
+        } break;
+        case RecordType::CoordOffsets:
+            for (auto coord : coords) {
+                if (!strcmp(coord->getName(), _name.c_str())) {
+                    float value[MAX_N_AXIS];
+                    coord->get(value);
+                    memcpy(value, _value.data(), std::min(_value.length(), sizeof(value)));
+                    coord->set(value);
+                    ++_offsets;
+                    break;
+                }
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+Error Backup::restore(const char* path, Channel& out) {
+    try {
+        FileStream   bundle(path, "r", "");
+        BundleHeader header;
+        size_t       size = bundle.size();
+        if (size < sizeof(header) + digest_size || bundle.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, bundle_magic, sizeof(header.magic)) || header.version != bundle_version) {
+            log_error_to(out, path << " is not a backup bundle");
+            return Error::InvalidValue;
+        }
+        size_t body = size - sizeof(header) - digest_size;
+
+        // The first pass checks the digest and the records, and the second applies them
+        for (bool apply : { false, true }) {
+            BundleDigest digest;
+            BundleReader reader(apply, out);
+            LzssDecoder  decoder([&](const uint8_t* data, size_t length) { reader.write(data, length); });
+            bool         good = true;
+
+            digest.update((const uint8_t*)&header, sizeof(header));
+            bundle.set_position(sizeof(header));
+            uint8_t buf[256];
+            for (size_t remaining = body; remaining && good;) {
+                size_t len = bundle.read(buf, std::min(remaining, sizeof(buf)));
+                if (len == 0) {
+                    return Error::FsFailedRead;
+                }
+                digest.update(buf, len);
+                good = decoder.write(buf, len);
+                remaining -= len;
+            }
+            good = good && decoder.finish() && reader.ok();
+
+            if (!apply) {
+                uint8_t sum[digest_size];
+                uint8_t expected[digest_size];
+                digest.finish(sum);
+                if (bundle.read(expected, digest_size) != digest_size || memcmp(sum, expected, digest_size)) {
+                    log_error_to(out, path << " is corrupt, its checksum does not match");
+                    return Error::InvalidValue;
+                }
+            }
+            if (!good) {
+                log_error_to(out, path << " is corrupt");
+                return Error::InvalidValue;
+            }
+            if (apply) {
+                Coordinates::flush(true);
+                log_info_to(out,
+                            "Restored " << reader._files << " files, " << reader._settings << " settings and " << reader._offsets
+                                        << " coordinate systems");
+                if (reader._failed) {
+                    log_warn_to(out, reader._failed << " items were not restored");
+                }
+                if (reader._config) {
+                    log_info_to(out, "Restart to use the restored configuration file");
+                }
+            }
+        }
+    } catch (Error err) {
+        return err;
+    } catch (const std::bad_alloc&) {
+        log_error_to(out, "Not enough memory to restore a backup");
+        return Error::FsFailedRead;
+    }
+    return Error::Ok;
+}
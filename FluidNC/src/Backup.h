@@ -0,0 +1,24 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// A backup bundle is one file that holds what it takes to set up another
+// controller like this one - the configuration file, the settings that
+// differ from their defaults, the coordinate systems, and the files that
+// the macros run.  The file can be fetched and uploaded like any other,
+// over HTTP or with $Xmodem/Send and $Xmodem/Receive.
+//
+// The bundle is a header, then the records compressed with LZSS, then the
+// SHA-256 of everything before it.  Each record is a type byte, the length
+// of the name in one byte, the length of the data in four bytes, the name
+// and the data.  Restoring checks the whole bundle before it changes anything.
+
+#include "Channel.h"
+#include "Error.h"
+
+class Backup {
+public:
+    static Error save(const char* path, Channel& out);
+    static Error restore(const char* path, Channel& out);
+};
@@ -8,6 +8,7 @@
 #include "Limits.h"
 #include "Logging.h"
 #include "Job.h"
+#include "LogPool.h"
 #include <string_view>
 #include <algorithm>
 
@@ -85,68 +86,74 @@ bool Channel::lineComplete(char* line, char ch) {
     return false;
 }
 
+// Delta and binary reports are small enough to permit higher report rates
+uint32_t Channel::minReportInterval() {
+    return _reportOptions.mode == ReportMode::Full ? 50 : 10;
+}
+
 uint32_t Channel::setReportInterval(uint32_t ms) {
     uint32_t actual = ms;
     if (actual) {
-        actual = std::max(actual, uint32_t(50));
+        actual = std::max(actual, minReportInterval());
     }
-    _reportInterval = actual;
-    _nextReportTime = int32_t(xTaskGetTickCount());
-    _lastTool       = 255;  // Force GCodeState report
+    _reportInterval   = actual;
+    _nextReportTime   = int32_t(xTaskGetTickCount());
+    _reportGCodeState = true;
     return actual;
 }
+void Channel::setReportOptions(const ReportOptions& options) {
+    _reportOptions = options;
+    if (_reportInterval) {
+        _reportInterval = std::max(_reportInterval, minReportInterval());
+    }
+    _lastStatusValid = false;  // Force a complete report
+    _reportOvr       = true;
+    _reportWco       = true;
+}
+
 static bool motionState() {
     return state_is(State::Cycle) || state_is(State::Homing) || state_is(State::Jog);
 }
 
-void Channel::autoReportGCodeState() {
-    // When moving, we suppress $G reports in which the only change is the motion mode
-    // (e.g. G0/G1/G2/G3 changes) because rapid-fire motion mode changes are fairly common.
-    // We would rather not issue a $G report after every GCode line.
-    // Similarly, F and S values can change rapidly, especially in laser programs.
-    // F and S values are also reported in ? status reports, so they will show up
-    // at the chosen periodic rate there.
-    if (motionState()) {
-        // Force the compare to succeed if the only change is the motion mode
-        _lastModal.motion = gc_state.modal.motion;
-    }
-    if (memcmp(&_lastModal, &gc_state.modal, sizeof(_lastModal)) || _lastTool != gc_state.selected_tool ||
-        (!motionState() && (_lastSpindleSpeed != gc_state.spindle_speed || _lastFeedRate != gc_state.feed_rate))) {
-        report_gcode_modes(*this);
-        memcpy(&_lastModal, &gc_state.modal, sizeof(_lastModal));
-        _lastTool         = gc_state.selected_tool;
-        _lastSpindleSpeed = gc_state.spindle_speed;
-        _lastFeedRate     = gc_state.feed_rate;
+bool Channel::statusReportDue(const StatusValues& values, int32_t now) {
+    bool jobActive = values.job_hash != 0;
+    bool periodic  = motionState() && (now - _nextReportTime) >= 0;
+    if (!(_reportOvr || _reportWco || values.state != _lastStateName || strcmp(values.pins, _lastPins) || periodic ||
+          (_lastJobActive != jobActive))) {
+        return false;
+    }
+    if (_reportOvr) {
+        report_ovr_counter = 0;
+        _reportOvr         = false;
     }
+    if (_reportWco) {
+        report_wco_counter = 0;
+        _reportWco         = false;
+    }
+    _lastStateName = values.state;
+    _lastJobActive = jobActive;
+    strcpy(_lastPins, values.pins);
+
+    // Periodic reports advance the deadline by whole intervals so a late
+    // tick does not shift the cadence, unless they have fallen so far
+    // behind that it is better to start over.
+    if (periodic) {
+        _nextReportTime += _reportInterval;
+    }
+    if (!periodic || (now - _nextReportTime) >= 0) {
+        _nextReportTime = now + _reportInterval;
+    }
+    return true;
 }
-void Channel::autoReport() {
-    if (_reportInterval) {
-        auto thisProbeState = config->_probe->get_state();
-        report_recompute_pin_string();
-        const char* stateName = state_name();
-        if (_reportOvr || _reportWco || stateName != _lastStateName || thisProbeState != _lastProbe || _lastPinString != report_pin_string ||
-            (motionState() && (int32_t(xTaskGetTickCount()) - _nextReportTime) >= 0) || (_lastJobActive != Job::active())) {
-            if (_reportOvr) {
-                report_ovr_counter = 0;
-                _reportOvr         = false;
-            }
-            if (_reportWco) {
-                report_wco_counter = 0;
-                _reportWco         = false;
-            }
-            _lastStateName = stateName;
-            _lastProbe     = thisProbeState;
-            _lastPinString = report_pin_string;
-            _lastJobActive = Job::active();
 
-            _nextReportTime = xTaskGetTickCount() + _reportInterval;
-            report_realtime_status(*this);
-        }
-        if (_reportNgc != CoordIndex::End) {
-            report_ngc_coord(_reportNgc, *this);
-            _reportNgc = CoordIndex::End;
-        }
-        autoReportGCodeState();
+void Channel::autoReport(const StatusValues& values) {
+    if (_reportNgc != CoordIndex::End) {
+        report_ngc_coord(_reportNgc, *this);
+        _reportNgc = CoordIndex::End;
+    }
+    if (_reportGCodeState) {
+        report_gcode_modes(*this);
+        _reportGCodeState = false;
     }
 }
 
@@ -240,9 +247,6 @@ Error Channel::pollLine(char* line) {
             return Error::Ok;
         }
     }
-    if (_active) {
-        autoReport();
-    }
     return Error::NoData;
 }
 
@@ -288,6 +292,12 @@ void Channel::print_msg(MsgLevel level, const char* msg) {
     }
 }
 
+void Channel::print_line(MsgLevel level, const char* line, size_t len) {
+    if (_message_level >= level) {
+        write(reinterpret_cast<const uint8_t*>(line), len);
+    }
+}
+
 // This overload is used primarily with fixed string
 // values.  It sends a pointer to the string whose
 // memory does not need to be reclaimed later.
@@ -295,7 +305,7 @@ void Channel::print_msg(MsgLevel level, const char* msg) {
 // with fixed messages.
 void Channel::sendLine(MsgLevel level, const char* line) {
     if (outputTask) {
-        LogMessage msg { this, (void*)line, level, false };
+        LogMessage msg { this, (void*)line, level, LogMessage::Kind::Fixed, 0 };
         while (!xQueueSend(message_queue, &msg, 10)) {}
     } else {
         print_msg(level, line);
@@ -312,10 +322,11 @@ void Channel::sendLine(MsgLevel level, const char* line) {
 // is allocated once and freed once.
 void Channel::sendLine(MsgLevel level, const std::string* line) {
     if (outputTask) {
-        LogMessage msg { this, (void*)line, level, true };
+        LogMessage msg { this, (void*)line, level, LogMessage::Kind::String, 0 };
         while (!xQueueSend(message_queue, &msg, 10)) {}
     } else {
-        print_msg(level, line->c_str());
+        print_line(level, line->c_str(), line->length());
+        print_line(level, "\n", 1);
         delete line;
     }
 }
@@ -323,22 +334,51 @@ void Channel::sendLine(MsgLevel level, const std::string* line) {
 // This overload is used for many miscellaneous messages
 // where the std::string is allocated in a code block and
 // then extended with various information.  This send_line()
-// copies that string to a newly allocated one and sends that
-// via the std::string* version of send_line().  The original
-// string is freed by the caller sometime after send_line()
-// returns, while the new string is freed by the output task
-// after the message is forwared to the output channel.
-// This is the least efficient form, requiring two strings
-// to be allocated and freed, with an intermediate copy.
-// It is used only rarely.
+// copies that string into a LogPool buffer, or if none is
+// available or the string is too long, to a newly allocated
+// string that is sent via the std::string* version of
+// send_line().  The original string is freed by the caller
+// sometime after send_line() returns.
 void Channel::sendLine(MsgLevel level, const std::string& line) {
     if (outputTask) {
-        sendLine(level, new std::string(line));
+        LogBuffer* buf = line.length() <= LogBuffer::max_text ? LogPool::acquire(level) : nullptr;
+        if (buf) {
+            buf->append(reinterpret_cast<const uint8_t*>(line.c_str()), line.length());
+            sendLine(level, buf);
+        } else {
+            LogPool::count_heap_fallback();
+            sendLine(level, new std::string(line));
+        }
     } else {
         print_msg(level, line.c_str());
     }
 }
 
+// This overload is used by LogStream, which formats messages
+// directly into a preallocated LogPool buffer.  The output
+// task releases the buffer back to the pool after sending it.
+// Log messages - as opposed to MsgLevelNone protocol data -
+// never block the sender; if the queue is full, the message
+// is dropped and counted instead.
+void Channel::sendLine(MsgLevel level, LogBuffer* line) {
+    if (outputTask) {
+        LogMessage msg { this, (void*)line, level, LogMessage::Kind::Pooled, LogPool::queue(line) };
+        if (level != MsgLevelNone) {
+            // If steal_oldest() got to the buffer first, it counted the drop
+            if (!xQueueSend(message_queue, &msg, 0) && LogPool::withdraw(line, msg.ticket)) {
+                LogPool::count_drop();
+            }
+            return;
+        }
+        while (!xQueueSend(message_queue, &msg, 10)) {}
+    } else {
+        // The text can be a binary status frame, so it is sent by length
+        line->text[line->len++] = '\n';
+        print_line(level, line->text, line->len);
+        LogPool::release(line);
+    }
+}
+
 bool Channel::is_visible(const std::string& stem, std::string extension, bool isdir) {
     if (stem.length() && stem[0] == '.') {
         // Exclude hidden files and directories
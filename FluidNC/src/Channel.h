@@ -21,6 +21,7 @@
 #include "src/Types.h"        // State
 #include "src/RealtimeCmd.h"  // Cmd
 #include "src/UTF8.h"
+#include "src/StatusReport.h"  // ReportOptions
 
 #include "src/Pins/PinAttributes.h"
 #include "src/Machine/EventPin.h"
@@ -29,6 +30,8 @@
 #include <freertos/FreeRTOS.h>  // TickType_T
 #include <queue>
 
+struct LogBuffer;
+
 class Channel : public Stream {
 private:
     void pin_event(uint32_t pinnum, bool active);
@@ -61,19 +64,20 @@ protected:
     uint32_t _reportInterval = 0;
     int32_t  _nextReportTime = 0;
 
-    gc_modal_t  _lastModal        = modal_defaults;
-    uint8_t     _lastTool         = 0;
-    float       _lastSpindleSpeed = 0;
-    float       _lastFeedRate     = 0;
-    const char* _lastStateName    = "";
-    MotorMask   _lastLimits       = 0;
-    bool        _lastProbe        = false;
-    bool        _lastJobActive    = false;
-    std::string _lastPinString    = "";
+    const char* _lastStateName = "";
+    MotorMask   _lastLimits    = 0;
+    bool        _lastJobActive = false;
+
+    char _lastPins[sizeof(StatusValues::pins)] = "";
 
-    bool       _reportOvr = true;
-    bool       _reportWco = true;
-    CoordIndex _reportNgc = CoordIndex::End;
+    bool       _reportOvr        = true;
+    bool       _reportWco        = true;
+    bool       _reportGCodeState = true;
+    CoordIndex _reportNgc        = CoordIndex::End;
+
+    ReportOptions _reportOptions;
+    StatusValues  _lastStatus;
+    bool          _lastStatusValid = false;
 
     Cmd _last_rt_cmd = Cmd::None;
 
@@ -104,6 +108,7 @@ public:
     virtual void sendLine(MsgLevel level, const char* line);
     virtual void sendLine(MsgLevel level, const std::string* line);
     virtual void sendLine(MsgLevel level, const std::string& line);
+    virtual void sendLine(MsgLevel level, LogBuffer* line);
 
     size_t _line_number = 0;
 
@@ -156,6 +161,18 @@ public:
     void notifyOvr() { _reportOvr = true; }
     void notifyWco() { _reportWco = true; }
     void notifyNgc(CoordIndex coord) { _reportNgc = coord; }
+    void notifyGCodeState() { _reportGCodeState = true; }
+
+    const ReportOptions& reportOptions() { return _reportOptions; }
+    void                 setReportOptions(const ReportOptions& options);
+
+    // The status values that were last reported to this channel, or nullptr
+    // if the next report must be complete.
+    const StatusValues* lastStatus() { return _lastStatusValid ? &_lastStatus : nullptr; }
+    void                setLastStatus(const StatusValues& values) {
+        _lastStatus      = values;
+        _lastStatusValid = true;
+    }
 
     int peek() override { return -1; }
     int read() override { return -1; }
@@ -163,12 +180,35 @@ public:
 
     virtual void print_msg(MsgLevel level, const char* msg);
 
+    // print_line() is like print_msg() except that the line already ends with
+    // a newline, so it can be written with a single write() call.  Channels
+    // that assemble output into lines - like WSChannel - can then send it
+    // directly from the caller's buffer instead of copying it.
+    virtual void print_line(MsgLevel level, const char* line, size_t len);
+
     void print_msg(MsgLevel level, const std::string& msg) { print_msg(level, msg.c_str()); }
 
-    uint32_t     setReportInterval(uint32_t ms);
-    uint32_t     getReportInterval() { return _reportInterval; }
-    virtual void autoReport();
-    void         autoReportGCodeState();
+    uint32_t setReportInterval(uint32_t ms);
+    uint32_t getReportInterval() { return _reportInterval; }
+    uint32_t minReportInterval();
+
+    // Automatic reports are scheduled by AllChannels::dispatchReports(),
+    // which captures one status snapshot per tick and offers it to every
+    // channel that has a report interval.
+    //
+    // canAutoReport() returns false if the channel cannot take output now.
+    // statusReportDue() returns true if a status report should be sent,
+    // either because something changed or because the periodic deadline
+    // has passed while in motion, and then advances the deadline.
+    // autoReport() sends any other pending reports, like $G and NGC
+    // changes.  Channels that display status in other ways, rather than
+    // by sending reports, override autoReport() to use the values.
+    virtual bool canAutoReport() { return _active; }
+    virtual bool statusReportDue(const StatusValues& values, int32_t now);
+    virtual void autoReport(const StatusValues& values);
+
+    // The time of the next periodic report, for the scheduler
+    int32_t reportDeadline() { return _nextReportTime; }
 
     void push(uint8_t byte);
     void push(const uint8_t* data, size_t length) {
@@ -19,7 +19,7 @@ namespace Configuration {
     }
 
     void GCodeParam::enterSection(const char* name, Configuration::Configurable* value) {
-        if (is(name) && !isHandled_) {
+        if (!isHandled_ && is(name)) {
             auto previous = start_;
 
             // Figure out next node
@@ -5,6 +5,7 @@
 
 #include "HandlerBase.h"
 #include "Configurable.h"
+#include "src/string_util.h"
 
 namespace Configuration {
     class GCodeParam : public Configuration::HandlerBase {
@@ -15,15 +16,7 @@ namespace Configuration {
         bool   _get;
         float& _iovalue;
 
-        bool is(const char* name) const {
-            if (start_ != nullptr) {
-                auto len    = strlen(name);
-                auto result = !strncasecmp(name, start_, len) && (start_[len] == '\0' || start_[len] == '/');
-                return result;
-            } else {
-                return false;
-            }
-        }
+        bool is(const char* name) const { return start_ != nullptr && string_util::segment_is(start_, name); }
         void error();
 
     protected:
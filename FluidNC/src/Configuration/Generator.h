@@ -4,7 +4,8 @@
 #pragma once
 
 #include <vector>
-#include <sstream>
+#include <cstdio>
+#include <cstring>
 
 #include "src/Pin.h"
 #include "src/Report.h"    // report_gcode_modes()
@@ -23,11 +24,16 @@ namespace Configuration {
         Channel& dst_;
         bool     lastIsNewline_ = false;
 
-        inline void indent() {
+        // Starts an item line in s.  Values are then written straight into
+        // the line, so the dump holds one line at a time however large the
+        // configuration is.
+        void begin_item(LogStream& s, const char* name) {
             lastIsNewline_ = false;
             for (int i = 0; i < indent_ * 2; ++i) {
-                dst_ << ' ';
+                s << ' ';
             }
+            s << name;
+            s << ": ";
         }
 
         void enter(const char* name);
@@ -42,17 +48,12 @@ namespace Configuration {
     public:
         Generator(Channel& dst, int indent = 0);
 
-        void send_item(const char* name, const std::string& value) {
+        void send_item(const char* name, const char* value) {
             LogStream s(dst_, "");
-            lastIsNewline_ = false;
-            for (int i = 0; i < indent_ * 2; ++i) {
-                s << ' ';
-            }
-            s << name;
-            s << ": ";
+            begin_item(s, name);
 
             // If value contains a colon, wrap text as string
-            if (value.find(':') == std::string::npos) {
+            if (!strchr(value, ':')) {
                 s << value;
             } else {
                 s << "'";
@@ -60,47 +61,52 @@ namespace Configuration {
                 s << "'";
             }
         }
+        void send_item(const char* name, const std::string& value) { send_item(name, value.c_str()); }
 
         void item(const char* name, int& value, const int32_t minValue, const int32_t maxValue) override {
-            send_item(name, std::to_string(value));
+            LogStream s(dst_, "");
+            begin_item(s, name);
+            s << value;
         }
 
         void item(const char* name, uint32_t& value, const uint32_t minValue, const uint32_t maxValue) override {
-            send_item(name, std::to_string(value));
+            LogStream s(dst_, "");
+            begin_item(s, name);
+            s << static_cast<unsigned int>(value);
         }
 
         void item(const char* name, float& value, const float minValue, const float maxValue) override {
-            send_item(name, std::to_string(value));
+            // The same format as std::to_string(), which this used to call
+            char buf[48];
+            snprintf(buf, sizeof(buf), "%f", value);
+            send_item(name, buf);
         }
 
         void item(const char* name, std::vector<speedEntry>& value) {
             if (value.size() == 0) {
                 send_item(name, "None");
-            } else {
-                std::ostringstream s;
-                s.precision(2);
-                const char* separator = "";
-                for (speedEntry n : value) {
-                    s << separator << n.speed << "=" << std::fixed << n.percent << "%";
-                    separator = " ";
-                }
-                send_item(name, s.str());
+                return;
+            }
+            LogStream   s(dst_, "");
+            const char* separator = "";
+            begin_item(s, name);
+            for (speedEntry n : value) {
+                s << separator << static_cast<unsigned int>(n.speed) << "=" << setprecision(2) << n.percent << "%";
+                separator = " ";
             }
         }
 
         void item(const char* name, std::vector<float>& value) {
             if (value.size() == 0) {
                 send_item(name, "None");
-            } else {
-                std::ostringstream s;
-                s.precision(3);
-                s << std::fixed;
-                const char* separator = "";
-                for (float n : value) {
-                    s << separator << n;
-                    separator = " ";
-                }
-                send_item(name, s.str());
+                return;
+            }
+            LogStream   s(dst_, "");
+            const char* separator = "";
+            begin_item(s, name);
+            for (float n : value) {
+                s << separator << setprecision(3) << n;
+                separator = " ";
             }
         }
 
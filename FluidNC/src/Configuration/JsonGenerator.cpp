@@ -8,8 +8,6 @@
 #include <cstring>
 #include <cstdio>
 #include <atomic>
-#include <sstream>
-#include <iomanip>
 
 namespace Configuration {
     JsonGenerator::JsonGenerator(JSONencoder& encoder) : _encoder(encoder) {
@@ -94,9 +92,9 @@ namespace Configuration {
         } else if (value < -999999.999f) {
             value = -999999.999f;
         }
-        std::ostringstream fstr;
-        fstr << std::fixed << std::setprecision(3) << value;
-        _encoder.begin_webui(_currentPath, _currentPath, "R", fstr.str());
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.3f", value);
+        _encoder.begin_webui(_currentPath, _currentPath, "R", buf);
         _encoder.end_object();
         leave();
     }
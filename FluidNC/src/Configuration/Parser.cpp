@@ -15,7 +15,7 @@
 #include <string_view>
 
 namespace Configuration {
-    Parser::Parser(std::string_view yaml_string) : Tokenizer(yaml_string) {}
+    Parser::Parser(std::string_view yaml_string, bool snapshot) : Tokenizer(yaml_string, snapshot) {}
 
     void Parser::parseError(const char* description) const {
         // Attempt to use the correct position in the parser:
@@ -30,11 +30,7 @@ namespace Configuration {
         if (_token._state != TokenState::Matching || _token._key.empty()) {
             return false;
         }
-        auto len = strlen(expected);
-        if (len != _token._key.size()) {
-            return false;
-        }
-        bool result = !strncasecmp(expected, _token._key.cbegin(), len);
+        bool result = string_util::equal_ignore_case(_token._key, expected);
         if (result) {
             _token._state = TokenState::Matched;
         }
@@ -29,7 +29,7 @@ namespace Configuration {
     }
 
     void RuntimeSetting::enterSection(const char* name, Configuration::Configurable* value) {
-        if (is(name) && !isHandled_) {
+        if (!isHandled_ && is(name)) {
             auto previous = start_;
 
             // Figure out next node
@@ -292,6 +292,7 @@ namespace Configuration {
                 log_stream(out_, setting_prefix() << value.name());
             } else {
                 log_string(out_, "Runtime setting of Pin objects is not supported");
+                needsRestart_ = true;
                 // auto parsed = Pin::create(newValue);
                 // value.swap(parsed);
             }
@@ -305,6 +306,7 @@ namespace Configuration {
                 log_stream(out_, setting_prefix() << value.name());
             } else {
                 log_string(out_, "Runtime setting of Pin objects is not supported");
+                needsRestart_ = true;
                 // auto parsed = Pin::create(newValue);
                 // value.swap(parsed);
             }
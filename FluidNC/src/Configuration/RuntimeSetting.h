@@ -5,6 +5,7 @@
 
 #include "HandlerBase.h"
 #include "Configurable.h"
+#include "src/string_util.h"
 
 namespace Configuration {
     class RuntimeSetting : public Configuration::HandlerBase {
@@ -16,15 +17,7 @@ namespace Configuration {
 
         Channel& out_;
 
-        bool is(const char* name) const {
-            if (start_ != nullptr) {
-                auto len    = strlen(name);
-                auto result = !strncasecmp(name, start_, len) && (start_[len] == '\0' || start_[len] == '/');
-                return result;
-            } else {
-                return false;
-            }
-        }
+        bool is(const char* name) const { return start_ != nullptr && string_util::segment_is(start_, name); }
 
     protected:
         void enterSection(const char* name, Configuration::Configurable* value) override;
@@ -51,7 +44,8 @@ namespace Configuration {
 
         HandlerType handlerType() override { return HandlerType::Runtime; }
 
-        bool isHandled_ = false;
+        bool isHandled_    = false;
+        bool needsRestart_ = false;  // The value can only be set by loading the configuration file
 
         virtual ~RuntimeSetting();
     };
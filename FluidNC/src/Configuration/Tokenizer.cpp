@@ -7,11 +7,13 @@
 #include "ParseException.h"
 #include "parser_logging.h"
 
+#include <cstdint>
 #include <cstdlib>
 
 namespace Configuration {
 
-    Tokenizer::Tokenizer(std::string_view yaml_string) : _remainder(yaml_string), _linenum(0), _token() {}
+    Tokenizer::Tokenizer(std::string_view yaml_string, bool snapshot) :
+        _remainder(yaml_string), _snapshot(snapshot), _linenum(0), _token() {}
 
     bool Tokenizer::isWhiteSpace(char c) {
         return c == ' ' || c == '\t' || c == '\f' || c == '\r';
@@ -102,6 +104,57 @@ namespace Configuration {
         return true;
     }
 
+    // A snapshot record is a little-endian header followed by the text of
+    // the key and the value, neither NUL-terminated:
+    //   uint16_t linenum;
+    //   uint8_t  indent;
+    //   uint8_t  key_length;
+    //   uint16_t value_length;
+    static const size_t record_header = 6;
+
+    bool Tokenizer::encode(std::string_view yaml_string, std::string& out) {
+        Tokenizer tokenizer(yaml_string);
+        for (tokenizer.Tokenize(); tokenizer._token._state != TokenState::Eof; tokenizer.Tokenize()) {
+            auto& token = tokenizer._token;
+            if (tokenizer._linenum > UINT16_MAX || token._indent > UINT8_MAX || token._key.size() > UINT8_MAX ||
+                token._value.size() > UINT16_MAX) {
+                return false;
+            }
+            char header[record_header] = {
+                char(tokenizer._linenum), char(tokenizer._linenum >> 8), char(token._indent),
+                char(token._key.size()),  char(token._value.size()),     char(token._value.size() >> 8),
+            };
+            out.append(header, record_header);
+            out.append(token._key);
+            out.append(token._value);
+        }
+        return true;
+    }
+
+    // Sets _token from the next snapshot record.
+    // Returns false at end of input
+    bool Tokenizer::nextRecord() {
+        if (_remainder.empty()) {
+            return false;
+        }
+        if (_remainder.size() < record_header) {
+            ParseError("Truncated snapshot");
+        }
+        auto   header       = reinterpret_cast<const uint8_t*>(_remainder.data());
+        size_t key_length   = header[3];
+        size_t value_length = header[4] | header[5] << 8;
+        if (_remainder.size() < record_header + key_length + value_length) {
+            ParseError("Truncated snapshot");
+        }
+
+        _linenum       = header[0] | header[1] << 8;
+        _token._indent = header[2];
+        _token._key    = _remainder.substr(record_header, key_length);
+        _token._value  = _remainder.substr(record_header + key_length, value_length);
+        _remainder.remove_prefix(record_header + key_length + value_length);
+        return true;
+    }
+
     void Tokenizer::parseValue() {
         // Remove initial whitespace
         while (!_line.empty() && isWhiteSpace(_line.front())) {
@@ -150,7 +203,11 @@ namespace Configuration {
         // We parse 1 line at a time. Each time we get here, we can assume that the cursor
         // is at the start of the line.
 
-        if (nextLine()) {
+        if (_snapshot) {
+            if (nextRecord()) {
+                return;
+            }
+        } else if (nextLine()) {
             parseKey();
             parseValue();
             return;
@@ -5,17 +5,20 @@
 #pragma once
 
 #include "TokenState.h"
-#include "../Config.h"
+
+#include <string>
 #include <string_view>
 
 namespace Configuration {
 
     class Tokenizer {
         std::string_view _remainder;
+        bool             _snapshot;  // _remainder holds records from encode(), not YAML
 
         bool isWhiteSpace(char c);
         bool isIdentifierChar(char c);
         bool nextLine();
+        bool nextRecord();
         void parseKey();
         void parseValue();
 
@@ -28,7 +31,7 @@ namespace Configuration {
             // The initial value for indent is -1, so when ParserHandler::enterSection()
             // is called to handle the top level of the YAML config file, tokens at
             // indent 0 will be processed.
-            TokenData() : _key({}), _value({}), _indent(-1), _state(TokenState::Bof) {}
+            TokenData() : _key(), _value(), _indent(-1), _state(TokenState::Bof) {}
             std::string_view _key;
             std::string_view _value;
             int              _indent;
@@ -39,8 +42,14 @@ namespace Configuration {
         void ParseError(const char* description) const;
 
     public:
-        explicit Tokenizer(std::string_view yaml_string);
+        explicit Tokenizer(std::string_view yaml_string, bool snapshot = false);
         void                    Tokenize();
         inline std::string_view key() const { return _token._key; }
+
+        // Appends a compact record for each token of yaml_string to out.  A
+        // Tokenizer constructed on the records with snapshot true produces
+        // the same tokens without scanning the YAML text again.  Returns
+        // false if a token is too large for a record.
+        static bool encode(std::string_view yaml_string, std::string& out);
     };
 }
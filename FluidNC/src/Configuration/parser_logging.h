@@ -1,9 +1,20 @@
 #pragma once
 
+#ifdef __FLUIDNC
+#    include "../Logging.h"
+#endif
+
 static constexpr bool verbose_debugging = false;
-#define log_parser_verbose(x)                                                                                                              \
-    do {                                                                                                                                   \
-        if (verbose_debugging) {                                                                                                           \
-            log_debug(x);                                                                                                                  \
-        }                                                                                                                                  \
-    } while (0)
+#ifdef __FLUIDNC
+#    define log_parser_verbose(x)                                                                                                          \
+        do {                                                                                                                               \
+            if (verbose_debugging) {                                                                                                       \
+                log_debug(x);                                                                                                              \
+            }                                                                                                                              \
+        } while (0)
+#else
+// Host tests build the tokenizer without the logging system
+#    define log_parser_verbose(x)                                                                                                          \
+        do {                                                                                                                               \
+        } while (0)
+#endif
@@ -28,6 +28,8 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <string>
+#include <vector>
 
 #define DEGRAD (180 / M_PI)
 #define RADDEG (M_PI / 180)
@@ -37,7 +39,7 @@
 
 #include "Expression.h"
 
-#define MAX_STACK 7
+#define MAX_STACK 16
 
 typedef enum {
     Binary_NoOp = 0,
@@ -129,9 +131,6 @@ static Error execute_binary1(float& lhs, ngc_binary_op_t operation, const float&
             status = Error::ExpressionUnknownOp;
     }
 
-    if (status != Error::Ok)
-        report_param_error(status);
-
     return status;
 }
 
@@ -608,6 +607,15 @@ static Error read_operation_unary(const char* line, size_t& pos, ngc_unary_op_t&
     return status;
 }
 
+/*! \brief Executes the two-argument ATAN operation.
+
+\param value the first argument and the result, in degrees.
+\param argument2 the second argument.
+*/
+static void execute_atan(float& value, float argument2) {
+    value = atan2f(value, argument2) * DEGRAD; /* value in radians, convert to degrees */
+}
+
 /*! \brief Reads a slash and the second argument to the ATAN function,
 starting at the index given by the pos offset. Then it computes the value
 of the ATAN operation applied to the two arguments.
@@ -631,7 +639,7 @@ static Error read_atan(const char* line, size_t& pos, float& value) {
     Error status;
 
     if ((status = expression(line, pos, argument2)) == Error::Ok)
-        value = atan2f(value, argument2) * DEGRAD; /* value in radians, convert to degrees */
+        execute_atan(value, argument2);
 
     return status;
 }
@@ -680,21 +688,18 @@ Error read_unary(const char* line, size_t& pos, float& value) {
     return execute_unary(value, operation);
 }
 
-/*! \brief Evaluate expression and set result if successful.
+/*! \brief Evaluate expression by interpreting its text.
 
 \param line pointer to RS274/NGC code (block).
-\param pos offset into line where expression starts.
+\param pos offset into line where expression starts, after the [.
 \param value pointer to float where result is to be stored.
 \returns #Error::Ok enum value if evaluated without error, appropriate \ref Error enum value if not.
 */
-Error expression(const char* line, size_t& pos, float& value) {
+static Error interpret(const char* line, size_t& pos, float& value) {
     float           values[MAX_STACK];
     ngc_binary_op_t operators[MAX_STACK];
     uint_fast8_t    stack_index = 1;
 
-    if (line[pos] != '[')
-        return Error::GcodeUnsupportedCommand;
-
     pos++;
 
     Error status;
@@ -716,8 +721,10 @@ Error expression(const char* line, size_t& pos, float& value) {
             stack_index++;
         else {  // precedence of latest operator is <= previous precedence
             for (; precedence(operators[stack_index]) <= precedence(operators[stack_index - 1]);) {
-                if ((status = execute_binary(values[stack_index - 1], operators[stack_index - 1], values[stack_index])) != Error::Ok)
+                if ((status = execute_binary(values[stack_index - 1], operators[stack_index - 1], values[stack_index])) != Error::Ok) {
+                    report_param_error(status);
                     return status;
+                }
 
                 operators[stack_index - 1] = operators[stack_index];
                 // auto o1 = operators[stack_index - 1];
@@ -737,3 +744,359 @@ Error expression(const char* line, size_t& pos, float& value) {
 
     return Error::Ok;
 }
+
+/* Compiled expressions
+
+An expression is compiled, the first time it is seen, into a small RPN
+program that is cached by its source text.  Evaluating the program takes
+no parsing at all: numbers have been converted, operator names decoded,
+named parameters interned and the order of operations resolved, and
+subexpressions whose operands are all constants have been folded into
+constants.  Files that compute coordinates in every line with the same
+expressions, only the parameter values changing, benefit the most.
+
+The compiler handles what is common: numbers, #number and #<name>
+parameters, nested brackets, operators and functions other than EXISTS.
+Anything else, including every syntax error, is left to the interpreter,
+which is the reference for the result and for the error reported.
+*/
+
+enum ExprCode : uint8_t {
+    Expr_Constant,  // Push value
+    Expr_Param,     // Push the value of param
+    Expr_Negate,    // Negate the top value
+    Expr_Unary,     // Apply unary op to the top value
+    Expr_Atan,      // Replace the top two values with ATAN[y]/[x]
+    Expr_Binary,    // Replace the top two values with lhs op rhs
+};
+
+struct ExprStep {
+    ExprCode    code;
+    uint8_t     op;
+    uint8_t     depth;  // Bracket nesting depth, 0 for the top level
+    float       value;
+    param_ref_t param;
+};
+
+static const size_t max_expr_steps = 64;
+
+class ExprCompiler {
+    std::vector<ExprStep>& _steps;
+    size_t                 _sp     = 0;  // Stack depth at run time
+    uint8_t                _depth  = 0;
+    bool                   _failed = false;
+
+    void emit(ExprCode code, uint8_t op = 0, float value = 0.0f, const param_ref_t& param = param_ref_t()) {
+        if (_steps.size() == max_expr_steps) {
+            _failed = true;
+            return;
+        }
+        _steps.push_back({ code, op, _depth, value, param });
+        switch (code) {
+            case Expr_Constant:
+            case Expr_Param:
+                if (++_sp > MAX_STACK) {
+                    _failed = true;
+                }
+                break;
+            case Expr_Atan:
+            case Expr_Binary:
+                --_sp;
+                break;
+            default:
+                break;
+        }
+    }
+
+    // Folding replaces the constant operands of an operation with its result,
+    // unless the operation fails, in which case the error is left to run time.
+    bool constant_operands(size_t n) const {
+        if (_steps.size() < n) {
+            return false;
+        }
+        for (size_t i = _steps.size() - n; i < _steps.size(); ++i) {
+            if (_steps[i].code != Expr_Constant) {
+                return false;
+            }
+        }
+        return true;
+    }
+    void fold(size_t n, float value) {
+        _steps.resize(_steps.size() - n);
+        _sp -= n;
+        emit(Expr_Constant, 0, value);
+    }
+
+    void negate() {
+        if (constant_operands(1)) {
+            _steps.back().value = -_steps.back().value;
+            return;
+        }
+        emit(Expr_Negate);
+    }
+    void unary(ngc_unary_op_t op) {
+        if (constant_operands(1)) {
+            float value = _steps.back().value;
+            if (execute_unary(value, op) == Error::Ok) {
+                fold(1, value);
+                return;
+            }
+        }
+        emit(Expr_Unary, op);
+    }
+    void atan() {
+        if (constant_operands(2)) {
+            float value = _steps[_steps.size() - 2].value;
+            execute_atan(value, _steps.back().value);
+            fold(2, value);
+            return;
+        }
+        emit(Expr_Atan);
+    }
+    void binary(ngc_binary_op_t op) {
+        if (constant_operands(2)) {
+            float lhs = _steps[_steps.size() - 2].value;
+            if (execute_binary(lhs, op, _steps.back().value) == Error::Ok) {
+                fold(2, lhs);
+                return;
+            }
+        }
+        emit(Expr_Binary, op);
+    }
+
+    // The same grammar as read_number() with in_expression true
+    bool operand(const char* line, size_t& pos) {
+        char c = line[pos];
+        if (c == '#') {
+            ++pos;
+            c = line[pos];
+            // Indirect references depend on parameter values
+            if (c == '#' || c == '[') {
+                return false;
+            }
+            param_ref_t param;
+            if (!get_param_ref(line, pos, param)) {
+                return false;
+            }
+            emit(Expr_Param, 0, 0.0f, param);
+            return true;
+        }
+        if (c == '[') {
+            return bracketed(line, pos);
+        }
+        if (isalpha(c)) {
+            ngc_unary_op_t op;
+            if (read_operation_unary(line, pos, op) != Error::Ok || op == Unary_Exists || line[pos] != '[') {
+                return false;
+            }
+            ++_depth;
+            bool ok = bracketed(line, pos);
+            if (ok && op == Unary_ATAN) {
+                ok = line[pos] == '/' && line[++pos] == '[' && bracketed(line, pos);
+                if (ok) {
+                    atan();
+                }
+            } else if (ok) {
+                unary(op);
+            }
+            --_depth;
+            return ok;
+        }
+        if (c == '-') {
+            ++pos;
+            if (!operand(line, pos)) {
+                return false;
+            }
+            negate();
+            return true;
+        }
+        if (c == '+') {
+            ++pos;
+            return operand(line, pos);
+        }
+        float value;
+        if (!read_float(line, pos, value)) {
+            return false;
+        }
+        emit(Expr_Constant, 0, value);
+        return true;
+    }
+
+    // The same grammar and precedence rules as interpret()
+    bool bracketed(const char* line, size_t& pos) {
+        ngc_binary_op_t operators[MAX_STACK];
+        size_t          n_operators = 0;
+        ngc_binary_op_t operation;
+
+        ++pos;
+        ++_depth;
+        if (!operand(line, pos) || read_operation(line, pos, operation) != Error::Ok) {
+            return false;
+        }
+        while (operation != Binary_RightBracket) {
+            while (n_operators && precedence(operators[n_operators - 1]) >= precedence(operation)) {
+                binary(operators[--n_operators]);
+            }
+            if (n_operators == MAX_STACK) {
+                return false;
+            }
+            operators[n_operators++] = operation;
+            if (!operand(line, pos) || read_operation(line, pos, operation) != Error::Ok) {
+                return false;
+            }
+        }
+        while (n_operators) {
+            binary(operators[--n_operators]);
+        }
+        --_depth;
+        return !_failed;
+    }
+
+public:
+    ExprCompiler(std::vector<ExprStep>& steps) : _steps(steps) {}
+
+    // The top level expression is depth 0
+    bool compile(const char* line, size_t& pos) {
+        _depth = uint8_t(-1);
+        return bracketed(line, pos) && !_failed;
+    }
+};
+
+static Error run(const std::vector<ExprStep>& steps, float& result) {
+    float  stack[MAX_STACK];
+    size_t sp = 0;
+    for (auto& step : steps) {
+        Error status = Error::Ok;
+        switch (step.code) {
+            case Expr_Constant:
+                stack[sp++] = step.value;
+                continue;
+            case Expr_Param:
+                // As in read_number(), which fails the whole expression
+                if (!read_param(step.param, stack[sp++])) {
+                    return Error::BadNumberFormat;
+                }
+                continue;
+            case Expr_Negate:
+                stack[sp - 1] = -stack[sp - 1];
+                continue;
+            case Expr_Unary:
+                status = execute_unary(stack[sp - 1], ngc_unary_op_t(step.op));
+                break;
+            case Expr_Atan:
+                --sp;
+                execute_atan(stack[sp - 1], stack[sp]);
+                continue;
+            case Expr_Binary:
+                --sp;
+                status = execute_binary(stack[sp - 1], ngc_binary_op_t(step.op), stack[sp]);
+                if (status != Error::Ok) {
+                    report_param_error(status);
+                }
+                break;
+        }
+        if (status != Error::Ok) {
+            // A failure inside an operand makes read_number() fail,
+            // which the enclosing expression reports as a bad number.
+            if (step.depth) {
+                log_debug(errorString(status));
+                return Error::BadNumberFormat;
+            }
+            return status;
+        }
+    }
+    result = stack[0];
+    return Error::Ok;
+}
+
+struct CachedExpr {
+    std::string           text;
+    uint32_t              hash      = 0;
+    uint32_t              last_used = 0;
+    bool                  compiled  = false;  // Else the interpreter evaluates it
+    std::vector<ExprStep> steps;
+};
+
+static const size_t n_cached_exprs = 16;
+static CachedExpr   cached_exprs[n_cached_exprs];
+static uint32_t     expr_clock = 0;
+
+// Finds the ] that matches the [ at pos, returning the offset after it,
+// or 0 if there is none.  Parameter names can contain any character.
+static size_t expression_end(const char* line, size_t pos) {
+    int  depth = 0;
+    char c;
+    for (; (c = line[pos]) != '\0'; ++pos) {
+        if (c == '<') {
+            while (line[pos] && line[pos] != '>') {
+                ++pos;
+            }
+            if (!line[pos]) {
+                return 0;
+            }
+        } else if (c == '[') {
+            ++depth;
+        } else if (c == ']' && --depth == 0) {
+            return pos + 1;
+        }
+    }
+    return 0;
+}
+
+static CachedExpr* cached_expression(const char* line, size_t pos, size_t end) {
+    const char* text = line + pos;
+    size_t      len  = end - pos;
+
+    uint32_t hash = 2166136261u;  // FNV-1a
+    for (size_t i = 0; i < len; ++i) {
+        hash = (hash ^ uint8_t(text[i])) * 16777619u;
+    }
+
+    CachedExpr* victim = &cached_exprs[0];
+    for (auto& entry : cached_exprs) {
+        if (entry.hash == hash && entry.text.length() == len && !memcmp(entry.text.data(), text, len)) {
+            entry.last_used = ++expr_clock;
+            return &entry;
+        }
+        if (entry.last_used < victim->last_used) {
+            victim = &entry;
+        }
+    }
+
+    victim->text.assign(text, len);
+    victim->hash      = hash;
+    victim->last_used = ++expr_clock;
+    victim->steps.clear();
+    size_t compile_pos = pos;
+    victim->compiled   = ExprCompiler(victim->steps).compile(line, compile_pos) && compile_pos == end;
+    if (!victim->compiled) {
+        victim->steps.clear();
+        victim->steps.shrink_to_fit();
+    }
+    return victim;
+}
+
+/*! \brief Evaluate expression and set result if successful.
+
+\param line pointer to RS274/NGC code (block).
+\param pos offset into line where expression starts.
+\param value pointer to float where result is to be stored.
+\returns #Error::Ok enum value if evaluated without error, appropriate \ref Error enum value if not.
+*/
+Error expression(const char* line, size_t& pos, float& value) {
+    if (line[pos] != '[')
+        return Error::GcodeUnsupportedCommand;
+
+    size_t end = expression_end(line, pos);
+    if (end) {
+        auto entry = cached_expression(line, pos, end);
+        if (entry->compiled) {
+            Error status = run(entry->steps, value);
+            if (status == Error::Ok) {
+                pos = end;
+            }
+            return status;
+        }
+    }
+    return interpret(line, pos, value);
+}
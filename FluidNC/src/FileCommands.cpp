@@ -5,11 +5,16 @@
 #include "src/Settings.h"
 #include "src/WebUI/Authentication.h"
 #include "src/Configuration/JsonGenerator.h"
-#include "src/InputFile.h"    // InputFile
-#include "src/Job.h"          // Job::
-#include "src/xmodem.h"       // xmodemReceive(), xmodemTransmit()
-#include "src/Protocol.h"     // pollingPaused
-#include "src/string_util.h"  // split_prefix()
+#include "src/InputFile.h"              // InputFile
+#include "src/Job.h"                    // Job::
+#include "src/xmodem.h"                 // xmodemReceive(), xmodemTransmit()
+#include "src/Protocol.h"               // pollingPaused
+#include "src/string_util.h"            // split_prefix()
+#include "src/MotionControl.h"          // mc_analyzer
+#include "src/Limits.h"                 // limitsMinPosition()
+#include "src/Report.h"                 // report_feedback_message()
+#include "src/Machine/MachineConfig.h"  // config
+#include "src/Machine/Macros.h"         // MacroCache
 
 #include "src/HashFS.h"
 
@@ -251,11 +256,22 @@ static Error runFile(const char* fs, const char* parameter, AuthenticationLevel
         return Error::IdleError;
     }
     Job::save();
+    std::string path(parameter);
+    if (!path.empty() && path[0] != '/') {
+        path = "/" + path;
+    }
+    if (auto cached = Machine::MacroCache::open(fs, path.c_str())) {
+        Job::nest(cached, &out);
+        return Error::Ok;
+    }
     InputFile* theFile;
     if ((err = openFile(fs, parameter, out, theFile)) != Error::Ok) {
         Job::restore();
         return err;
     }
+    if (theFile->use_preprocessed()) {
+        log_debug_to(out, "Running preprocessed " << theFile->name());
+    }
     Job::nest(theFile, &out);
 
     return Error::Ok;
@@ -270,6 +286,141 @@ static Error runLocalFile(const char* parameter, AuthenticationLevel auth_level,
     return runFile("", parameter, auth_level, out);
 }
 
+// Analysis runs a file in check mode with mc_analyzer set.  When the file
+// is closed - at its end, or when the job is aborted - the results are
+// reported and check mode is left the way $C leaves it.
+static Channel*    analysisOut = nullptr;
+static std::string analysisPath;
+
+static void finish_analysis() {
+    if (!mc_analyzer) {
+        return;
+    }
+    auto& out = *analysisOut;
+    mc_analyzer->finish();
+
+    uint32_t seconds = uint32_t(mc_analyzer->seconds() + 0.5f);
+    log_info_to(out,
+                "Analysis of " << analysisPath << ": " << mc_analyzer->moves() << " moves, estimated time " << seconds / 3600 << ":"
+                               << (seconds / 600) % 6 << (seconds / 60) % 10 << ":" << (seconds / 10) % 6 << seconds % 10);
+    log_info_to(out,
+                "Feed limited by max rate: " << mc_analyzer->rate_limited() << " moves, by acceleration: " << mc_analyzer->accel_limited()
+                                             << " moves");
+
+    float min[MAX_N_AXIS], max[MAX_N_AXIS];
+    if (mc_analyzer->bounds(min, max)) {
+        std::ostringstream msg;
+        msg << "Bounds" << std::fixed << std::setprecision(3);
+        for (size_t axis = 0; axis < Machine::Axes::_numberAxis; axis++) {
+            msg << " " << Machine::Axes::_names[axis] << ":" << min[axis] << ".." << max[axis];
+        }
+        log_info_to(out, msg.str());
+    }
+    if (mc_analyzer->violations()) {
+        log_warn_to(out,
+                    "Soft limits exceeded by " << mc_analyzer->violations() << " moves, first at line "
+                                               << mc_analyzer->first_violation_line());
+    } else {
+        log_info_to(out, "Within soft limits");
+    }
+
+    delete mc_analyzer;
+    mc_analyzer = nullptr;
+
+    report_feedback_message(Message::Disabled);
+    sys.abort = true;
+}
+
+static const NoArgEvent analysisDoneEvent { finish_analysis };
+
+static_assert(MAX_N_AXIS <= JobAnalyzer::max_axes, "JobAnalyzer::max_axes is too small");
+
+class AnalyzedFile : public InputFile {
+public:
+    AnalyzedFile(const char* fs, const char* path) : InputFile(fs, path) {}
+    // The job stack deletes the file in the polling task, so the results
+    // are reported from the protocol task
+    ~AnalyzedFile() { protocol_send_event(&analysisDoneEvent); }
+};
+
+static Error analyzeFile(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    if (!state_is(State::Idle) || mc_analyzer) {
+        return Error::IdleError;
+    }
+    if (*parameter == '\0') {
+        log_string(out, "Missing file name!");
+        return Error::InvalidValue;
+    }
+    std::string path(parameter);
+    if (path[0] != '/') {
+        path = "/" + path;
+    }
+    AnalyzedFile* theFile;
+    try {
+        theFile = new AnalyzedFile(fs, path.c_str());
+    } catch (Error err) { return err; }
+    theFile->use_preprocessed();
+
+    JobAnalyzer::Limits limits;
+    limits.n_axis = Machine::Axes::_numberAxis;
+    for (size_t axis = 0; axis < limits.n_axis; axis++) {
+        auto axisConfig           = Machine::Axes::_axis[axis];
+        limits.max_rate[axis]     = axisConfig->_maxRate;
+        limits.acceleration[axis] = axisConfig->_acceleration;
+        limits.min_position[axis] = limitsMinPosition(axis);
+        limits.max_position[axis] = limitsMaxPosition(axis);
+        limits.soft_limits[axis]  = axisConfig->_softLimits;
+    }
+    limits.junction_deviation = config->_junctionDeviation;
+    limits.planner_blocks     = config->_planner_blocks;
+
+    float motors[MAX_N_AXIS];
+    config->_kinematics->transform_cartesian_to_motors(motors, get_mpos());
+
+    mc_analyzer  = new JobAnalyzer(limits, motors);
+    analysisOut  = &out;
+    analysisPath = path;
+    set_state(State::CheckMode);
+    report_feedback_message(Message::Enabled);
+    Job::nest(theFile, &out);
+    return Error::Ok;
+}
+
+static Error analyzeSDFile(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    return analyzeFile(sdName, parameter, auth_level, out);
+}
+
+static Error analyzeLocalFile(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    return analyzeFile(localfsName, parameter, auth_level, out);
+}
+
+static Error preprocessFile(const char* fs, const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    if (notIdleOrAlarm()) {
+        return Error::IdleError;
+    }
+    if (*parameter == '\0') {
+        log_string(out, "Missing file name!");
+        return Error::InvalidValue;
+    }
+    std::string path(parameter);
+    if (path[0] != '/') {
+        path = "/" + path;
+    }
+    Error err = InputFile::preprocess(fs, path.c_str());
+    if (err == Error::Ok) {
+        log_info_to(out, "Preprocessed " << path);
+    }
+    return err;
+}
+
+static Error preprocessSDFile(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    return preprocessFile(sdName, parameter, auth_level, out);
+}
+
+static Error preprocessLocalFile(const char* parameter, AuthenticationLevel auth_level, Channel& out) {
+    return preprocessFile(localfsName, parameter, auth_level, out);
+}
+
 static Error deleteObject(const char* fs, const char* name, Channel& out) {
     std::error_code ec;
 
@@ -652,6 +803,8 @@ void make_file_commands() {
     new WebCommand("FORMAT", WEBCMD, WA, "ESP710", "LocalFS/Format", formatLocalFS);
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/Show", showLocalFile);
     new WebCommand("path", WEBCMD, WU, "ESP700", "LocalFS/Run", runLocalFile, nullptr);
+    new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/Preprocess", preprocessLocalFile);
+    new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/Analyze", analyzeLocalFile);
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/List", listLocalFiles);
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/ListJSON", listLocalFilesJSON);
     new WebCommand("path", WEBCMD, WU, NULL, "LocalFS/Delete", deleteLocalFile);
@@ -666,6 +819,8 @@ void make_file_commands() {
     new WebCommand("path", WEBCMD, WU, NULL, "File/ShowHash", fileShowHash);
     new WebCommand("path", WEBCMD, WU, "ESP221", "SD/Show", showSDFile);
     new WebCommand("path", WEBCMD, WU, "ESP220", "SD/Run", runSDFile, nullptr);
+    new WebCommand("path", WEBCMD, WU, NULL, "SD/Preprocess", preprocessSDFile);
+    new WebCommand("path", WEBCMD, WU, NULL, "SD/Analyze", analyzeSDFile);
     new WebCommand("file_or_directory_path", WEBCMD, WU, "ESP215", "SD/Delete", deleteSDObject);
     new WebCommand("path", WEBCMD, WU, NULL, "SD/Rename", renameSDObject);
     new WebCommand(NULL, WEBCMD, WU, "ESP210", "SD/List", listSDFiles);
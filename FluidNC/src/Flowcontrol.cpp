@@ -32,23 +32,31 @@ typedef enum {
     Op_EndRepeat,
     Op_Return,
     Op_RaiseAlarm,
-    Op_RaiseError
+    Op_RaiseError,
+    Op_Sub,
+    Op_EndSub,
+    Op_Call
 } ngc_cmd_t;
 
 typedef struct {
     uint32_t    o_label;
     ngc_cmd_t   operation;
     JobSource*  file;
-    size_t      file_pos;
+    size_t      file_pos;  // Loop start, or return address for Op_Call
     std::string expr;
     uint32_t    repeats;
     bool        skip;
     bool        handled;
     bool        brk;
+    bool        looping;      // file is caching the loop body
+    size_t      line_number;  // Op_Call - line number of the CALL
+    LocalParams locals;       // Op_Call - caller's #1-#30
 } ngc_stack_entry_t;
 
 std::stack<ngc_stack_entry_t> context;
 
+static int call_depth = 0;
+
 std::map<std::string, ngc_cmd_t, std::less<>> commands = {
     { "IF", Op_If },
     { "ELSEIF", Op_ElseIf },
@@ -64,6 +72,9 @@ std::map<std::string, ngc_cmd_t, std::less<>> commands = {
     { "RETURN", Op_Return },
     { "ALARM", Op_RaiseAlarm },
     { "ERROR", Op_RaiseError },
+    { "SUB", Op_Sub },
+    { "ENDSUB", Op_EndSub },
+    { "CALL", Op_Call },
 };
 
 static Error read_command(char* line, size_t& pos, ngc_cmd_t& operation) {
@@ -81,7 +92,7 @@ static Error read_command(char* line, size_t& pos, ngc_cmd_t& operation) {
 }
 
 static Error stack_push(uint32_t o_label, ngc_cmd_t operation, bool skip) {
-    ngc_stack_entry_t ent = { o_label, operation, Job::source(), 0, "", 0, skip, false, false };
+    ngc_stack_entry_t ent = { o_label, operation, Job::source(), 0, "", 0, skip, false, false, false, 0, {} };
     context.push(ent);
     return Error::Ok;
 }
@@ -89,9 +100,26 @@ static bool stack_pull(void) {
     if (context.empty()) {
         return false;
     }
+    auto& top = context.top();
+    // The job source might already be gone if the job was aborted
+    if (top.looping && top.file == Job::source()) {
+        top.file->end_loop();
+    }
+    if (top.operation == Op_Call) {
+        pop_local_params(top.locals);
+        --call_depth;
+    }
     context.pop();
     return true;
 }
+// Records the start of a loop body that can be jumped back to.  The job
+// source keeps the body in memory so later passes do not re-read the file.
+static void loop_start() {
+    auto& top    = context.top();
+    top.file_pos = top.file->position();
+    top.looping  = true;
+    top.file->begin_loop();
+}
 void unwind_stack() {
     if (context.empty()) {
         return;
@@ -101,6 +129,28 @@ void unwind_stack() {
         stack_pull();
     }
 }
+// Returns from the innermost subroutine call, which must be to o_label,
+// after closing any blocks that are open inside the subroutine.
+static Error sub_return(uint32_t o_label, bool has_value, float value) {
+    while (!context.empty() && context.top().operation != Op_Call) {
+        stack_pull();
+    }
+    if (context.empty() || context.top().o_label != o_label) {
+        return Error::FlowControlSyntaxError;
+    }
+    if (has_value) {
+        set_named_param("_VALUE", value);
+    }
+    set_named_param("_VALUE_RETURNED", has_value ? 1.0f : 0.0f);
+
+    auto& frame = context.top();
+    frame.file->return_subroutine(o_label);
+    frame.file->set_position(frame.file_pos);
+    frame.file->channel()->_line_number = frame.line_number;
+    stack_pull();  // Restores #1-#30
+    return Error::Ok;
+}
+
 void flowcontrol_init(void) {
     while (!context.empty()) {
         stack_pull();
@@ -171,7 +221,7 @@ Error flowcontrol(uint32_t o_label, char* line, size_t& pos, bool& skip) {
             if (Job::active()) {
                 if (!skipping) {
                     stack_push(o_label, operation, false);
-                    context.top().file_pos = context.top().file->position();
+                    loop_start();
                 }
             } else {
                 status = Error::FlowControlNotExecutingMacro;
@@ -197,9 +247,9 @@ Error flowcontrol(uint32_t o_label, char* line, size_t& pos, bool& skip) {
                     } else {
                         stack_push(o_label, operation, !value);
                         if (value) {
-                            context.top().expr     = expr;
-                            context.top().file     = Job::source();
-                            context.top().file_pos = context.top().file->position();
+                            context.top().expr = expr;
+                            context.top().file = Job::source();
+                            loop_start();
                         }
                     }
                 }
@@ -235,9 +285,9 @@ Error flowcontrol(uint32_t o_label, char* line, size_t& pos, bool& skip) {
                 if (!skipping && (status = expression(line, pos, value)) == Error::Ok) {
                     stack_push(o_label, operation, !value);
                     if (value) {
-                        context.top().file     = Job::source();
-                        context.top().file_pos = context.top().file->position();
-                        context.top().repeats  = (uint32_t)value;
+                        context.top().file    = Job::source();
+                        context.top().repeats = (uint32_t)value;
+                        loop_start();
                     }
                 }
             } else {
@@ -341,18 +391,78 @@ Error flowcontrol(uint32_t o_label, char* line, size_t& pos, bool& skip) {
 
         case Op_Return:
             if (Job::active()) {
-#if 0
-                if (!skipping && grbl.on_macro_return) {
-                    unwind_stack();
-                    if (expression(line, pos, value) == Error::Ok) {
-                        set_named_param("_value", value);
-                        set_named_param("_value_returned", 1.0f);
-                    } else {
-                        set_named_param("_value_returned", 0.0f);
+                if (!skipping) {
+                    bool has_value = line[pos] == '[';
+                    if (!has_value || (status = expression(line, pos, value)) == Error::Ok) {
+                        status = sub_return(o_label, has_value, value);
                     }
-                    grbl.on_macro_return();
                 }
-#endif
+            } else {
+                status = Error::FlowControlNotExecutingMacro;
+            }
+            break;
+
+        case Op_Sub:
+            if (Job::active()) {
+                if (!skipping) {
+                    // A definition that is reached in sequence is skipped
+                    // up to its ENDSUB; it only runs when called.
+                    Job::source()->define_subroutine(o_label);
+                    stack_push(o_label, operation, true);
+                }
+            } else {
+                status = Error::FlowControlNotExecutingMacro;
+            }
+            break;
+
+        case Op_EndSub:
+            if (Job::active()) {
+                if (last_op == Op_Sub && o_label == context.top().o_label) {
+                    stack_pull();
+                } else if (!skipping) {
+                    status = sub_return(o_label, false, 0.0f);
+                }
+            } else {
+                status = Error::FlowControlNotExecutingMacro;
+            }
+            break;
+
+        case Op_Call:
+            if (Job::active()) {
+                if (!skipping) {
+                    float  args[n_local_params];
+                    size_t n_args = 0;
+                    while (status == Error::Ok && line[pos] == '[') {
+                        if (n_args == n_local_params) {
+                            status = Error::FlowControlSyntaxError;
+                            break;
+                        }
+                        status = expression(line, pos, args[n_args++]);
+                    }
+                    if (status != Error::Ok) {
+                        break;
+                    }
+                    if (line[pos]) {
+                        status = Error::FlowControlSyntaxError;
+                        break;
+                    }
+                    if (call_depth >= NGC_STACK_DEPTH) {
+                        status = Error::FlowControlStackOverflow;
+                        break;
+                    }
+                    JobSource* file        = Job::source();
+                    size_t     return_pos  = file->position();
+                    size_t     line_number = file->channel()->_line_number;
+                    if (!file->call_subroutine(o_label)) {
+                        status = Error::FlowControlUnknownSubroutine;
+                        break;
+                    }
+                    stack_push(o_label, operation, false);
+                    context.top().file_pos    = return_pos;
+                    context.top().line_number = line_number;
+                    push_local_params(context.top().locals, args, n_args);
+                    ++call_depth;
+                }
             } else {
                 status = Error::FlowControlNotExecutingMacro;
             }
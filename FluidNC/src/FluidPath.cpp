@@ -9,7 +9,8 @@
 #include "FluidError.hpp"
 #include "HashFS.h"
 
-int FluidPath::_refcnt = 0;
+int      FluidPath::_refcnt    = 0;
+uint32_t FluidPath::_sd_mounts = 0;
 
 FluidPath::FluidPath(const char* name, const char* fs, std::error_code* ecptr) : std::filesystem::path(canonicalPath(name, fs)) {
     auto mount = *(++begin());  // Use the path iterator to get the first component
@@ -33,6 +34,7 @@ FluidPath::FluidPath(const char* name, const char* fs, std::error_code* ecptr) :
                 }
                 throw stdfs::filesystem_error { "SD card is inaccessible", name, ec };
             }
+            ++_sd_mounts;
         }
         ++_refcnt;
     }
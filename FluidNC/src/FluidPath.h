@@ -27,9 +27,14 @@ public:
     // /localfs/foo -> true,  /localfs -> false
     bool hasTail() { return ++(++begin()) != end(); }
 
+    // Counts the times the SD card has been mounted.  While the count is
+    // unchanged, the card cannot have been swapped.
+    static uint32_t sd_mounts() { return _sd_mounts; }
+
 private:
     FluidPath(const char* name, const char* fs, std::error_code*);
 
-    static int _refcnt;
-    bool       _isSD = false;
+    static int      _refcnt;
+    static uint32_t _sd_mounts;
+    bool            _isSD = false;
 };
@@ -20,6 +20,7 @@
 #include "Machine/MachineConfig.h"
 #include "Parameters.h"
 #include "Flowcontrol.h"
+#include "GCodeLexer.h"
 
 #include <string.h>  // memset
 #include <math.h>    // sqrt etc.
@@ -150,73 +151,19 @@ static void gcode_comment_msg(char* comment) {
 static std::optional<WaitOnInputMode> validate_wait_on_input_mode_value(uint8_t);
 static Error                          gc_wait_on_input(bool is_digital, uint8_t input_number, WaitOnInputMode mode, float timeout);
 
-// Edit GCode line in-place, removing whitespace and comments and
-// converting to uppercase
-void collapseGCode(char* line) {
-    // parenPtr, if non-NULL, is the address of the character after (
-    char* parenPtr = NULL;
-    // outPtr is the address where newly-processed characters will be placed.
-    // outPtr is alway less than or equal to inPtr.
-    char* outPtr = line;
-    char  c;
-    for (char* inPtr = line; (c = *inPtr) != '\0'; inPtr++) {
-        if (isspace(c)) {
-            continue;
-        }
-        switch (c) {
-            case ')':
-                if (parenPtr) {
-                    // Terminate comment by replacing ) with NUL
-                    *inPtr = '\0';
-                    gcode_comment_msg(parenPtr);
-                    parenPtr = NULL;
-                }
-                // Strip out ) that does not follow a (
-                break;
-            case '(':
-                if (gc_state.skip_blocks) {
-                    *line = '\0';
-                    return;
-                }
-
-                // Start the comment at the character after (
-                parenPtr = inPtr + 1;
-                break;
-            case ';':
-                if (gc_state.skip_blocks) {
-                    *line = '\0';
-                    return;
-                }
-                // NOTE: ';' comment to EOL is a LinuxCNC definition. Not NIST.
-                // gcode_comment_msg(inPtr + 1);
-                *outPtr = '\0';
-                return;
-            case '%':
-                // Per https://linuxcnc.org/docs/html/gcode/overview.html#gcode:file-requirements
-                // % only applies to "job" channels like files and macros, not to serial channels
-                // where the sequence of lines is potentially never-ending.  A sender that handles
-                // files on the host system could apply the % semantics.
-                if (Job::active()) {
-                    Job::channel()->percent();
-                }
-                break;
-            case '\r':
-                // In case one sneaks in
-                break;
-            default:
-                if (!parenPtr) {
-                    *outPtr++ = toupper(c);  // make upper case
-                }
-        }
-    }
-    // On loop exit, *inPtr is '\0'
-    if (parenPtr) {
-        // Handle unterminated ( comments
-        gcode_comment_msg(parenPtr);
+static void gcode_percent() {
+    // Per https://linuxcnc.org/docs/html/gcode/overview.html#gcode:file-requirements
+    // % only applies to "job" channels like files and macros, not to serial channels
+    // where the sequence of lines is potentially never-ending.  A sender that handles
+    // files on the host system could apply the % semantics.
+    if (Job::active()) {
+        Job::channel()->percent();
     }
-    *outPtr = '\0';
 }
 
+// Removes whitespace and comments, converts to upper case and extracts the words
+static GCodeLexer lexer(gcode_comment_msg, gcode_percent);
+
 void gc_ngc_changed(CoordIndex coord) {
     allChannels.notifyNgc(coord);
 }
@@ -232,6 +179,146 @@ void gc_wco_changed() {
     allChannels.notifyWco();
 }
 
+// Most lines of CAM output are plain moves like "G1 X1.2 Y3.4 F500" that
+// change no modes.  Such a block is executed here, directly from the lexed
+// words, skipping the block setup and the checks of the general parser.
+// Anything else - including a simple block with an error - returns false
+// with nothing changed, so the general parser handles it and reports errors.
+static bool gc_execute_simple_motion(Error& status) {
+    if (gc_state.modal.feed_rate != FeedRate::UnitsPerMin) {
+        return false;
+    }
+
+    Motion   motion = gc_state.modal.motion;
+    float    xyz[MAX_N_AXIS];
+    size_t   axis_words  = 0;
+    uint32_t letters     = 0;  // Letters seen, to reject repeated words
+    float    line_number = 0;
+    float    feed_rate   = gc_state.feed_rate;
+    bool     has_feed    = false;
+    auto     n_axis      = Axes::_numberAxis;
+
+    for (size_t i = 0; i < lexer.count(); ++i) {
+        char  letter = lexer.word(i).letter;
+        float value  = lexer.word(i).value;
+
+        uint32_t bit = bitnum_to_mask(letter - 'A');
+        if (letters & bit) {
+            return false;
+        }
+        letters |= bit;
+
+        size_t axis;
+        switch (letter) {
+            case 'G':
+                if (value == 0.0f) {
+                    motion = Motion::Seek;
+                } else if (value == 1.0f) {
+                    motion = Motion::Linear;
+                } else {
+                    return false;
+                }
+                continue;
+            case 'N':
+                if (value < 0.0f || value > MaxLineNumber) {
+                    return false;
+                }
+                line_number = value;
+                continue;
+            case 'F':
+                if (value < 0.0f) {
+                    return false;
+                }
+                feed_rate = value;
+                has_feed  = true;
+                continue;
+            case 'X':
+                axis = X_AXIS;
+                break;
+            case 'Y':
+                axis = Y_AXIS;
+                break;
+            case 'Z':
+                axis = Z_AXIS;
+                break;
+            case 'A':
+                axis = A_AXIS;
+                break;
+            case 'B':
+                axis = B_AXIS;
+                break;
+            case 'C':
+                axis = C_AXIS;
+                break;
+            default:
+                return false;
+        }
+        if (axis >= n_axis) {
+            return false;
+        }
+        xyz[axis] = value;
+        set_bitnum(axis_words, axis);
+    }
+
+    if (!axis_words || (motion != Motion::Seek && motion != Motion::Linear)) {
+        return false;
+    }
+    bool inches = gc_state.modal.units == Units::Inches;
+    if (has_feed && inches) {
+        feed_rate *= MM_PER_INCH;
+    }
+    if (motion == Motion::Linear && feed_rate == 0.0) {
+        return false;  // Let the general parser report the undefined feed rate
+    }
+
+    // The same conversions as the general parser, in the same order
+    for (size_t idx = 0; idx < n_axis; idx++) {
+        if (bitnum_is_false(axis_words, idx)) {
+            xyz[idx] = gc_state.position[idx];
+            continue;
+        }
+        if (inches && (idx < A_AXIS || idx > C_AXIS)) {
+            xyz[idx] *= MM_PER_INCH;
+        }
+        if (gc_state.modal.distance == Distance::Absolute) {
+            xyz[idx] += gc_state.coord_system[idx] + gc_state.coord_offset[idx];
+            if (idx == TOOL_LENGTH_OFFSET_AXIS) {
+                xyz[idx] += gc_state.tool_length_offset;
+            }
+        } else {
+            xyz[idx] += gc_state.position[idx];
+        }
+    }
+
+    plan_line_data_t plan_data;
+    memset(&plan_data, 0, sizeof(plan_line_data_t));
+
+    gc_state.line_number  = int32_t(truncf(line_number));
+    plan_data.line_number = gc_state.line_number;
+    gc_state.feed_rate    = feed_rate;
+    plan_data.feed_rate   = feed_rate;
+    // In laser mode, rapids are made with the laser off
+    if (motion == Motion::Linear || !spindle->isRateAdjusted()) {
+        plan_data.spindle_speed = gc_state.spindle_speed;
+    }
+    plan_data.spindle = gc_state.modal.spindle;
+    plan_data.coolant = gc_state.modal.coolant;
+
+    gc_state.modal.motion = motion;
+    if (motion == Motion::Seek) {
+        plan_data.motion.rapidMotion = 1;
+    }
+    mc_linear(xyz, &plan_data, gc_state.position);
+    if (sys.abort) {
+        status = Error::Reset;
+        return true;
+    }
+    copyAxes(gc_state.position, xyz);
+
+    status = perform_assignments() ? Error::Ok : Error::ParameterAssignmentFailed;
+    return true;
+}
+
 // Executes one line of NUL-terminated G-Code.
 // The line may contain whitespace and comments, which are first removed,
 // and lower case characters, which are converted to upper case.
@@ -239,8 +326,18 @@ void gc_wco_changed() {
 // exported to internal functions in terms of (mm, mm/min) and absolute machine
 // coordinates, respectively.
 Error gc_execute_line(char* line) {
-    // Step 0 - remove whitespace and comments and convert to upper case
-    collapseGCode(line);
+    // Step 0 - remove whitespace and comments, convert to upper case and
+    // extract the words that have plain numbers, starting after `$J=` if jogging
+    // NOTE: `$J=` already parsed when passed to this function.
+    lexer.lex(line, line[0] == '$' ? 3 : 0, gc_state.skip_blocks);
+
+    // Plain moves, if the lexer read all of the words, take the fast path
+    if (line[0] != '$' && line[lexer.rest()] == '\0' && !gc_state.skip_blocks) {
+        Error status;
+        if (gc_execute_simple_motion(status)) {
+            return status;
+        }
+    }
 
     /* -------------------------------------------------------------------------------------
        STEP 1: Initialize parser block struct and copy current g-code state modes. The parser
@@ -299,31 +396,42 @@ Error gc_execute_line(char* line) {
     float      value;
     int32_t    int_value = 0;
     int32_t    mantissa  = 0;
-    pos                  = jogMotion ? 3 : 0;  // Start parsing after `$J=` if jogging
-    while ((letter = line[pos]) != '\0') {     // Loop until no more g-code words in line.
-        if (letter == '#') {
-            if (gc_state.skip_blocks) {
-                return Error::Ok;
+    size_t     word      = 0;
+    pos                  = lexer.rest();
+    while (true) {  // Loop until no more g-code words in line.
+        if (word < lexer.count()) {
+            // The lexer has already read the words with plain numbers
+            letter = lexer.word(word).letter;
+            value  = lexer.word(word).value;
+            ++word;
+        } else {
+            if ((letter = line[pos]) == '\0') {
+                break;
             }
-            pos++;
-            if (!assign_param(line, pos)) {
-                FAIL(Error::BadNumberFormat);
+            if (letter == '#') {
+                if (gc_state.skip_blocks) {
+                    return Error::Ok;
+                }
+                pos++;
+                if (!assign_param(line, pos)) {
+                    FAIL(Error::BadNumberFormat);
+                }
+                continue;
             }
-            continue;
-        }
 
-        // XXX Should check that no other words are also present
-        if (bitnum_is_true(value_words, GCodeWord::O)) {
-            return flowcontrol(gc_block.values.o, line, pos, gc_state.skip_blocks);
-        }
+            // XXX Should check that no other words are also present
+            if (bitnum_is_true(value_words, GCodeWord::O)) {
+                return flowcontrol(gc_block.values.o, line, pos, gc_state.skip_blocks);
+            }
 
-        // Import the next g-code word, expecting a letter followed by a value. Otherwise, error out.
-        if ((letter < 'A') || (letter > 'Z')) {
-            FAIL(Error::ExpectedCommandLetter);  // [Expected word letter]
-        }
-        pos++;
-        if (!read_number(line, pos, value)) {
-            FAIL(Error::BadNumberFormat);  // [Expected word value]
+            // Import the next g-code word, expecting a letter followed by a value. Otherwise, error out.
+            if ((letter < 'A') || (letter > 'Z')) {
+                FAIL(Error::ExpectedCommandLetter);  // [Expected word letter]
+            }
+            pos++;
+            if (!read_number(line, pos, value)) {
+                FAIL(Error::BadNumberFormat);  // [Expected word value]
+            }
         }
         if (gc_state.skip_blocks && letter != 'O') {
             return Error::Ok;
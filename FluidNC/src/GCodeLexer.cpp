@@ -0,0 +1,328 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "GCodeLexer.h"
+
+#include <array>
+#include <cstdlib>
+#include <cstring>
+
+const float DecimalDigits::float_pow10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f };
+
+const DecimalDigits::Reciprocal DecimalDigits::reciprocals[] = {
+    { 0xcccccccccccccccd, 4 },  { 0xa3d70a3d70a3d70b, 7 },  { 0x83126e978d4fdf3c, 10 },
+    { 0xd1b71758e219652c, 14 }, { 0xa7c5ac471b478424, 17 }, { 0x8637bd05af6c69b6, 20 },
+    { 0xd6bf94d5e57a42bd, 24 }, { 0xabcc77118461cefd, 27 }, { 0x89705f4136b4a598, 30 },
+};
+
+// Powers of ten that are exact in double
+static const double double_pow10[] = { 1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+
+// Converts the numbers that value() cannot convert exactly in float
+float DecimalDigits::slow_value(const char* text) const {
+    if (!truncated) {
+        // Like value(), but in double.  Rounding that to float is a second
+        // rounding, which can be wrong only if the double is exactly halfway
+        // between two floats - the 29 bits that float does not keep are 1000...0.
+        if (mantissa <= (uint64_t(1) << 53) && exp >= -22 && exp <= 22) {
+            double   m = double(mantissa);
+            double   d = exp < 0 ? m / double_pow10[-exp] : m * double_pow10[exp];
+            uint64_t bits;
+            memcpy(&bits, &d, sizeof(bits));
+            if ((bits & 0x1fffffff) != 0x10000000) {
+                return float(d);
+            }
+        }
+    }
+
+    // strtof() would accept an exponent, which in G-code is the E word,
+    // so it is given only the digits and the decimal point.  The number
+    // comes from a line, so it is shorter than the buffer.
+    char   number[256];
+    size_t len   = 0;
+    bool   point = false;
+    for (char c; (c = *text) != '\0' && len < sizeof(number) - 1; ++text) {
+        if (c == '.' && !point) {
+            point = true;
+        } else if (c < '0' || c > '9') {
+            break;
+        }
+        number[len++] = c;
+    }
+    number[len] = '\0';
+    return strtof(number, nullptr);
+}
+
+// The paths that read_decimal() rarely takes are kept out of line so the
+// common path needs no stack frame for them.
+static float __attribute__((noinline)) slow_decimal(const char* text, uint32_t intval, int exp) {
+    DecimalDigits digits;
+    digits.mantissa = intval;
+    digits.exp      = exp;
+    return digits.value(text);
+}
+
+// Numbers with more than 9 digits
+static float __attribute__((noinline)) long_decimal(const char* text, const char*& end) {
+    const char*   ptr = text;
+    DecimalDigits digits;
+    while (1) {
+        char c = *ptr;
+        if (c >= '0' && c <= '9') {
+            digits.digit(c);
+        } else if (c == '.' && !(digits.isdecimal)) {
+            digits.isdecimal = true;
+        } else {
+            break;
+        }
+        ++ptr;
+    }
+    end = ptr;
+    return digits.value(text);
+}
+
+// Extracts a floating point value from a string.  Scientific notation is
+// officially not supported by g-code, and the 'E' character may be a g-code
+// word on some CNC systems. So, 'E' notation will not be recognized.
+bool read_decimal(const char* line, size_t& pos, float& result) {
+    const char* ptr = line + pos;
+
+    // Line is assumed to have no spaces
+
+    // Capture initial positive/minus character
+    char c          = *ptr;
+    bool isnegative = false;
+    if (c == '-') {
+        ++ptr;
+        isnegative = true;
+    } else if (c == '+') {
+        ++ptr;
+    }
+    const char* text = ptr;
+
+    // Numbers with up to 9 digits, which is nearly all of them, are
+    // accumulated in 32 bits, first the integer digits, then the fraction.
+    uint32_t    intval = 0;
+    const char* limit  = text + 9;
+    unsigned    digit;
+    while (ptr < limit && (digit = unsigned(*ptr - '0')) < 10) {
+        intval = intval * 10 + digit;
+        ++ptr;
+    }
+    int  ndigit = ptr - text;
+    int  exp    = 0;
+    bool point  = *ptr == '.';
+    if (point) {
+        const char* fraction = ++ptr;
+        ++limit;
+        while (ptr < limit && (digit = unsigned(*ptr - '0')) < 10) {
+            intval = intval * 10 + digit;
+            ++ptr;
+        }
+        exp = fraction - ptr;
+        ndigit -= exp;
+    }
+    // Return if no digits have been read.
+    if (!ndigit) {
+        return false;
+    }
+
+    float fval;
+    if (ptr < limit || (unsigned(*ptr - '0') >= 10 && (point || *ptr != '.'))) {
+        if (!DecimalDigits::convert(intval, exp, fval)) {
+            fval = slow_decimal(text, intval, exp);
+        }
+    } else {
+        fval = long_decimal(text, ptr);
+    }
+
+    result = isnegative ? -fval : fval;
+
+    pos = ptr - line;  // Set pos to next statement
+    return true;
+}
+
+enum CharClass : uint8_t {
+    Other,
+    Space,
+    Upper,
+    Lower,
+    Digit,
+    Point,
+    Sign,
+    OpenParen,
+    CloseParen,
+    Semicolon,
+    Percent,
+};
+
+static constexpr std::array<uint8_t, 256> make_char_classes() {
+    std::array<uint8_t, 256> classes {};
+    for (int c = 'A'; c <= 'Z'; ++c) {
+        classes[c]             = Upper;
+        classes[c + 'a' - 'A'] = Lower;
+    }
+    for (int c = '0'; c <= '9'; ++c) {
+        classes[c] = Digit;
+    }
+    // The same characters as isspace()
+    classes[' ']  = Space;
+    classes['\t'] = Space;
+    classes['\n'] = Space;
+    classes['\v'] = Space;
+    classes['\f'] = Space;
+    classes['\r'] = Space;
+
+    classes['.'] = Point;
+    classes['-'] = Sign;
+    classes['+'] = Sign;
+    classes['('] = OpenParen;
+    classes[')'] = CloseParen;
+    classes[';'] = Semicolon;
+    classes['%'] = Percent;
+    return classes;
+}
+
+static constexpr std::array<uint8_t, 256> char_classes = make_char_classes();
+
+// Feeds the extractor one character of the collapsed line, stored at offset at
+inline void GCodeLexer::extract(uint8_t cls, char c, size_t at) {
+    switch (_state) {
+        case Stopped:
+            return;
+        case Number:
+            if (cls == Digit) {
+                _digits.digit(c);
+                return;
+            }
+            if (cls == Point && !_digits.isdecimal) {
+                _digits.isdecimal = true;
+                return;
+            }
+            if (cls == Sign && !_signed && !_digits.ndigit && !_digits.isdecimal) {
+                _signed   = true;
+                _negative = c == '-';
+                return;
+            }
+            // Anything else ends the number
+            if (!_digits.ndigit) {
+                // Let read_number() deal with the whole word
+                stop(_word_start);
+                return;
+            }
+            finish(at);
+            if (_state == Stopped) {
+                return;
+            }
+            // fall through
+        case Letter:
+            if (cls != Upper || _count == max_words) {
+                stop(at);
+                return;
+            }
+            _words[_count].letter = c;
+            _word_start           = at;
+            _digits               = DecimalDigits();
+            _signed               = false;
+            _negative             = false;
+            _state                = Number;
+            return;
+    }
+}
+
+// Records the word whose number ends at offset end
+void GCodeLexer::finish(size_t end) {
+    float value          = _digits.value(_line + _word_start + 1 + _signed);
+    _words[_count].value = _negative ? -value : value;
+    if (_words[_count++].letter == 'O') {
+        // The rest of an O word line is interpreted by flow control
+        stop(end);
+        return;
+    }
+    _state = Letter;
+}
+
+void GCodeLexer::lex(char* line, size_t start, bool skipping) {
+    _line  = line;
+    _count = 0;
+    _state = Letter;
+
+    // paren, if non-NULL, is the address of the character after (
+    char* paren = nullptr;
+    // out is the address where newly-processed characters will be placed.
+    // out is always less than or equal to in.
+    char* out = line + start;
+    char  c;
+    for (char* in = out; (c = *in) != '\0'; in++) {
+        uint8_t cls = char_classes[uint8_t(c)];
+        switch (cls) {
+            case Space:
+                // Including '\r', in case one sneaks in
+                continue;
+            case CloseParen:
+                if (paren) {
+                    // Terminate comment by replacing ) with NUL
+                    *in = '\0';
+                    _comment(paren);
+                    paren = nullptr;
+                }
+                // Strip out ) that does not follow a (
+                continue;
+            case OpenParen:
+                if (skipping) {
+                    *line  = '\0';
+                    _count = 0;
+                    _rest  = 0;
+                    return;
+                }
+                // Start the comment at the character after (
+                paren = in + 1;
+                continue;
+            case Semicolon:
+                if (skipping) {
+                    *line  = '\0';
+                    _count = 0;
+                    _rest  = 0;
+                    return;
+                }
+                // NOTE: ';' comment to EOL is a LinuxCNC definition. Not NIST.
+                // An unterminated ( comment before it is not reported.
+                goto done;
+            case Percent:
+                // Whether % means anything depends on the channel, so the caller decides
+                _percent();
+                continue;
+            case Lower:
+                c += 'A' - 'a';  // make upper case
+                cls = Upper;
+                break;
+            default:
+                break;
+        }
+        if (!paren) {
+            *out = c;
+            extract(cls, c, out - line);
+            ++out;
+        }
+    }
+    // On loop exit, *in is '\0'
+    if (paren) {
+        // Handle unterminated ( comments
+        _comment(paren);
+    }
+done:
+    *out = '\0';
+
+    size_t end = out - line;
+    if (_state == Number) {
+        if (_digits.ndigit) {
+            finish(end);
+        } else {
+            stop(_word_start);
+        }
+    }
+    if (_state != Stopped) {
+        _rest = end;
+    }
+}
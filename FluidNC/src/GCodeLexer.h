@@ -0,0 +1,190 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// GCodeLexer makes one pass over a line of G-code.  It edits the line in
+// place, removing whitespace and comments and converting to upper case,
+// and while doing so it extracts the words of the block - a letter followed
+// by a plain decimal number, like X12.5 or G1 - into a fixed array.
+//
+// Words whose values need the general number reader - #parameters and
+// [expressions] - are not extracted.  Extraction stops at the first such
+// word, and also after an O word, whose remaining text belongs to flow
+// control.  The rest of the line is still collapsed, and rest() tells the
+// caller where to continue with read_number().
+//
+// The lexer has no dependencies on the rest of the firmware, so it can be
+// tested and benchmarked on the host.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Accumulates the digits of a decimal number as a 64-bit integer and a
+// power-of-ten exponent.  Both read_decimal() and the lexer use it, so
+// they convert the same digits to the same value.
+struct DecimalDigits {
+    static const size_t max_digits = 19;  // Significant digits that fit in uint64_t
+
+    uint64_t mantissa  = 0;
+    int      exp       = 0;
+    size_t   ndigit    = 0;      // All digits, including leading zeros
+    size_t   nsig      = 0;      // Significant digits in mantissa
+    bool     isdecimal = false;  // A decimal point has been seen
+    bool     truncated = false;  // Non-zero digits were dropped
+
+    inline void digit(char c) {
+        ndigit++;
+        if (nsig < max_digits) {
+            mantissa = mantissa * 10 + (c - '0');
+            if (mantissa) {
+                nsig++;
+            }
+            if (isdecimal) {
+                exp--;
+            }
+        } else {
+            if (c != '0') {
+                truncated = true;
+            }
+            if (!isdecimal) {
+                exp++;  // Drop overflow digits
+            }
+        }
+    }
+
+    // Converts to the nearest float, as strtof() would.  text points to
+    // the digits, after any sign, for the rare numbers that need strtof().
+    inline float value(const char* text) const {
+        float result;
+        if (!truncated && convert(mantissa, exp, result)) {
+            return result;
+        }
+        return slow_value(text);
+    }
+
+    // Converts mantissa * 10^exp to the nearest float for typical CAM numbers
+    // like 123.4567, returning false if the slower general method is needed.
+    static inline bool convert(uint64_t mantissa, int exp, float& result) {
+        if (mantissa >= (uint64_t(1) << 32)) {
+            return false;
+        }
+        uint32_t m = uint32_t(mantissa);
+        if (exp == 0 || m == 0) {
+            result = float(m);  // Correctly rounded
+            return true;
+        }
+        if (exp > 0) {
+            // An exact integer times an exact power of ten, rounded once
+            if (m > (uint32_t(1) << 24) || exp > 10) {
+                return false;
+            }
+            result = float(m) * float_pow10[exp];
+            return true;
+        }
+        if (-exp > max_recip) {
+            return false;
+        }
+        // m / 10^k without a division, which the ESP32 FPU lacks.  The
+        // reciprocal is rounded up, so the 96-bit product m * recip is the
+        // exact quotient, scaled by 2^(63+bits), plus less than m.  Only when
+        // the bits below the rounding bit are that close to zero can that
+        // error change the rounding, which is left to the slow path.  That
+        // includes the quotients exactly halfway between floats, which need
+        // ties to even.  With at most 24 bits in m, neither ever happens.
+        const Reciprocal& r    = reciprocals[-exp - 1];
+        uint64_t          lo   = uint64_t(m) * uint32_t(r.recip);
+        uint64_t          hi   = uint64_t(m) * uint32_t(r.recip >> 32) + (lo >> 32);
+        int               bits = 64 - __builtin_clzll(hi);  // At least 32, since recip >= 2^63
+        int               drop = bits - 25;                 // Leaves 24 bits and the rounding bit
+        uint32_t          sig  = uint32_t(hi >> drop);
+        if (sig & 1) {
+            if (!(hi & ((uint64_t(1) << drop) - 1))) {
+                return false;
+            }
+            sig += 1;  // Above halfway, so round up
+        }
+        // sig >> 1 includes the implicit leading 1, which adds one to the
+        // exponent field, and a carry out of rounding adds one more.
+        uint32_t f = (uint32_t(bits - 32 - r.bits + 126) << 23) + (sig >> 1);
+        memcpy(&result, &f, sizeof(result));
+        return true;
+    }
+
+private:
+    static const float float_pow10[];  // Powers of ten that are exact in float
+
+    // recip is 2^(63+bits) / 10^k rounded up, where 10^k has that many bits
+    struct Reciprocal {
+        uint64_t recip;
+        int      bits;
+    };
+    static const int        max_recip = 9;
+    static const Reciprocal reciprocals[max_recip];
+
+    float slow_value(const char* text) const;
+};
+
+// Reads an optionally signed decimal number without exponent, advancing pos
+// past it.  Returns false if there are no digits.  The result is exact -
+// the float nearest to the decimal value.
+bool read_decimal(const char* line, size_t& pos, float& result);
+
+class GCodeLexer {
+public:
+    struct Word {
+        char  letter;
+        float value;
+    };
+
+    static const size_t max_words = 32;
+
+    // Files that store collapsed lines, like InputFile sidecars, record this
+    // and are ignored when it differs.  Change it whenever lex() collapses
+    // lines differently.
+    static const uint16_t collapse_version = 1;
+
+    // comment is called with the text of each ( comment, NUL-terminated in place.
+    // percent is called for each %.
+    GCodeLexer(void (*comment)(char* text), void (*percent)()) : _comment(comment), _percent(percent) {}
+
+    // Collapses the line starting at offset start, and extracts its words.
+    // When skipping is true, a comment empties the entire line.
+    void lex(char* line, size_t start, bool skipping);
+
+    size_t      count() const { return _count; }
+    const Word& word(size_t i) const { return _words[i]; }
+
+    // The offset in the collapsed line where extraction stopped
+    size_t rest() const { return _rest; }
+
+private:
+    enum State : uint8_t {
+        Letter,   // Expecting the letter of a word
+        Number,   // Reading the value of a word
+        Stopped,  // Extraction has stopped, the line is only being collapsed
+    };
+
+    void (*_comment)(char* text);
+    void (*_percent)();
+
+    Word   _words[max_words];
+    size_t _count = 0;
+    size_t _rest  = 0;
+
+    // Word extraction state
+    State         _state;
+    char*         _line;
+    bool          _signed;      // The number has a leading sign
+    bool          _negative;    // ... which is -
+    size_t        _word_start;  // Offset of the letter of the current word
+    DecimalDigits _digits;
+
+    inline void extract(uint8_t cls, char c, size_t at);
+    void        finish(size_t end);
+    void        stop(size_t at) {
+        _state = Stopped;
+        _rest  = at;
+    }
+};
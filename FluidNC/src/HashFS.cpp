@@ -1,7 +1,10 @@
 #include "HashFS.h"
 #include "FileStream.h"
+#include "InputFile.h"       // InputFile::discard_preprocessed
+#include "Machine/Macros.h"  // MacroCache::forget
 
 #include <mbedtls/md.h>
+#include <cstdlib>
 
 std::map<std::string, std::string> HashFS::localFsHashes;
 
@@ -42,13 +45,125 @@ static Error hashFile(const std::filesystem::path& ipath, std::string& str) {  /
 
     return Error::Ok;
 }
+// The index file has a line for each file, with its digest, size,
+// modification time and key, separated by spaces
+static const char* index_name = ".hashes";
+
+std::map<std::string, HashFS::IndexEntry> HashFS::_index;
+bool                                      HashFS::_index_loaded = false;
+bool                                      HashFS::_index_dirty  = false;
 
 void HashFS::report_change() {
     log_msg("Files changed");
 }
 
+// Files are keyed by their path within the local filesystem, which for
+// files in its root directory is just the filename
+std::string HashFS::key(const std::filesystem::path& path) {
+    std::filesystem::path relative;
+    for (auto it = std::next(path.begin(), 2); it != path.end(); ++it) {
+        relative /= *it;
+    }
+    return relative.string();
+}
+
+bool HashFS::stamp(const std::filesystem::path& path, IndexEntry& entry) {
+    std::error_code ec;
+    entry.size = stdfs::file_size(path, ec);
+    if (ec) {
+        return false;
+    }
+    auto time = stdfs::last_write_time(path, ec);
+    if (ec) {
+        return false;
+    }
+    entry.mtime = time.time_since_epoch().count();
+    return true;
+}
+
+void HashFS::load_index() {
+    if (_index_loaded) {
+        return;
+    }
+    _index_loaded = true;
+
+    std::string text;
+    try {
+        std::error_code ec;
+        FluidPath       fpath { index_name, localfsName, ec };
+        if (ec) {
+            return;
+        }
+        FileStream index(fpath, "r");
+        text.resize(index.size());
+        if (index.read(text.data(), text.length()) != text.length()) {
+            return;
+        }
+    } catch (...) { return; }
+
+    for (size_t pos = 0, end; pos < text.length(); pos = end + 1) {
+        end = text.find('\n', pos);
+        if (end == std::string::npos) {
+            end = text.length();
+        }
+        std::string line(text, pos, end - pos);
+        auto        space = line.find(' ');
+        if (space == std::string::npos) {
+            continue;
+        }
+        IndexEntry entry;
+        entry.hash  = line.substr(0, space);
+        char* next  = &line[space];
+        entry.size  = strtoull(next, &next, 10);
+        entry.mtime = strtoll(next, &next, 10);
+        if (*next == ' ' && next[1]) {
+            _index[next + 1] = entry;
+        }
+    }
+}
+
+void HashFS::save_index() {
+    if (!_index_dirty) {
+        return;
+    }
+    try {
+        std::error_code ec;
+        FluidPath       fpath { index_name, localfsName, ec };
+        if (ec) {
+            return;
+        }
+        FileStream index(fpath, "w");
+        for (const auto& [name, entry] : _index) {
+            std::string line = entry.hash + ' ' + std::to_string(entry.size) + ' ' + std::to_string(entry.mtime) + ' ' + name + '\n';
+            index.write((const uint8_t*)line.c_str(), line.length());
+        }
+        _index_dirty = false;
+    } catch (...) { log_debug("Cannot write " << index_name); }
+}
+
 void HashFS::delete_file(const std::filesystem::path& path, bool report) {
-    localFsHashes.erase(path.filename());
+    InputFile::discard_preprocessed(path);
+    Machine::MacroCache::forget(path);
+    if (file_is_hashable(path)) {
+        load_index();
+
+        // Deleting a directory deletes the files in it
+        auto name   = key(path);
+        auto prefix = name + '/';
+        auto erase  = [&](auto& map) {
+            for (auto it = map.begin(); it != map.end();) {
+                if (it->first == name || it->first.compare(0, prefix.length(), prefix) == 0) {
+                    it           = map.erase(it);
+                    _index_dirty = true;
+                } else {
+                    ++it;
+                }
+            }
+        };
+        erase(localFsHashes);
+        erase(_index);
+        save_index();
+    }
     if (report) {
         report_change();
     }
@@ -60,22 +175,68 @@ bool HashFS::file_is_hashable(const std::filesystem::path& path) {
         ++count;
     }
     // The first component is "/", then e.g. "littlefs", then
-    // the filename.  If there are more components, there is
-    // a subdirectory and we do not hash it.
-    if (count != 3) {
+    // the path within the filesystem, which can include
+    // subdirectories.
+    if (count < 3) {
         return false;
     }
     auto fsname = *++path.begin();
-    return fsname == "littlefs" || fsname == "spiffs" || fsname == "localfs";
+    if (fsname != "littlefs" && fsname != "spiffs" && fsname != "localfs") {
+        return false;
+    }
+    return count > 3 || path.filename() != index_name;
+}
+
+// Uses the digest in the index if the file has the same size and
+// modification time as when it was indexed
+bool HashFS::lookup_index(const std::filesystem::path& path) {
+    auto name = key(path);
+    auto it   = _index.find(name);
+    if (it == _index.end()) {
+        return false;
+    }
+    IndexEntry entry;
+    if (!stamp(path, entry) || entry.size != it->second.size || entry.mtime != it->second.mtime) {
+        return false;
+    }
+    localFsHashes[name] = it->second.hash;
+    return true;
+}
+
+// Adds the digest of a file, reading the file unless reuse is true
+// and the digest in the index is still valid
+bool HashFS::add_file(const std::filesystem::path& path, bool reuse) {
+    if (reuse && lookup_index(path)) {
+        return true;
+    }
+    auto       name = key(path);
+    IndexEntry entry;
+    if (!stamp(path, entry) || hashFile(path, entry.hash) != Error::Ok) {
+        return false;
+    }
+    localFsHashes[name] = entry.hash;
+    _index[name]        = entry;
+    _index_dirty        = true;
+    return true;
 }
 
 void HashFS::rehash_file(const std::filesystem::path& path, bool report) {
+    InputFile::discard_preprocessed(path);
+    Machine::MacroCache::forget(path);
     if (file_is_hashable(path)) {
-        std::string hash;
-        if (hashFile(path, hash) != Error::Ok) {
-            delete_file(path, false);
+        load_index();
+        std::error_code ec;
+        if (stdfs::is_directory(path, ec)) {
+            for (auto const& dir_entry : stdfs::recursive_directory_iterator { path, ec }) {
+                if (!dir_entry.is_directory()) {
+                    add_file(dir_entry, false);
+                }
+            }
+            save_index();
+        } else if (add_file(path, false)) {
+            save_index();
         } else {
-            localFsHashes[path.filename()] = hash;
+            delete_file(path, false);
         }
     }
     if (report) {
@@ -96,24 +257,42 @@ void HashFS::hash_all() {
         return;
     }
 
-    auto iter = stdfs::directory_iterator { lfspath, ec };
+    auto iter = stdfs::recursive_directory_iterator { lfspath, ec };
     if (ec) {
         log_error(lfspath << " " << ec.message());
         return;
     }
+    load_index();
     for (auto const& dir_entry : iter) {
-        if (!dir_entry.is_directory()) {
-            rehash_file(dir_entry, false);
+        if (!dir_entry.is_directory() && file_is_hashable(dir_entry)) {
+            add_file(dir_entry, true);
         }
     }
+
+    // Forget the files that are gone
+    for (auto it = _index.begin(); it != _index.end();) {
+        if (localFsHashes.count(it->first)) {
+            ++it;
+        } else {
+            it           = _index.erase(it);
+            _index_dirty = true;
+        }
+    }
+    save_index();
 }
+
 std::string HashFS::hash(const std::filesystem::path& path, bool useCacheOnly /*= false*/) {
     if (file_is_hashable(path)) {
-        std::map<std::string, std::string>::const_iterator it;
-        it = localFsHashes.find(path.filename());
+        auto name = key(path);
+        auto it   = localFsHashes.find(name);
         if (it != localFsHashes.end()) {
             return it->second;
         }
+        // Before hash_all() has run, the index can supply the digest
+        load_index();
+        if (lookup_index(path)) {
+            return localFsHashes[name];
+        }
     } else if (!useCacheOnly) {
         std::string theHash;
         hashFile(path, theHash);
@@ -2,6 +2,7 @@
 #include <string>
 #include <map>
 #include <filesystem>
+#include <cstdint>
 
 class HashFS {
 public:
@@ -17,4 +18,22 @@ public:
     static std::string hash(const std::filesystem::path& path, bool useCacheOnly = false);
 
 private:
+    // The digests are kept in an index file on the local filesystem, with
+    // the size and modification time of each file, so they are computed
+    // again only for files that changed.
+    struct IndexEntry {
+        std::string hash;
+        uintmax_t   size;
+        int64_t     mtime;
+    };
+    static std::map<std::string, IndexEntry> _index;
+    static bool                              _index_loaded;
+    static bool                              _index_dirty;
+
+    static std::string key(const std::filesystem::path& path);
+    static bool        stamp(const std::filesystem::path& path, IndexEntry& entry);
+    static bool        lookup_index(const std::filesystem::path& path);
+    static bool        add_file(const std::filesystem::path& path, bool reuse);
+    static void        load_index();
+    static void        save_index();
 };
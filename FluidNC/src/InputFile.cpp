@@ -4,8 +4,147 @@
 #include "InputFile.h"
 
 #include "Report.h"
+#include "HashFS.h"
+#include "GCodeLexer.h"
+#include "Sidecar.h"
+
+#include <cstring>
 
 InputFile::InputFile(const char* defaultFs, const char* path) : FileStream(path, "r", defaultFs) {}
+
+static std::string sidecar_path(const std::filesystem::path& fpath) {
+    return (fpath.parent_path() / ("." + fpath.filename().string() + ".pre")).string();
+}
+
+static bool source_mtime(const std::filesystem::path& fpath, int64_t& mtime) {
+    std::error_code ec;
+    auto            time = stdfs::last_write_time(fpath, ec);
+    mtime                = time.time_since_epoch().count();
+    return !ec;
+}
+
+void InputFile::discard_preprocessed(const std::filesystem::path& fpath) {
+    std::error_code ec;
+    stdfs::remove(sidecar_path(fpath), ec);
+}
+
+// Comments and % are left in the lines that are kept as they are,
+// so the lexer never calls these.
+static GCodeLexer collapser([](char* text) {}, []() {});
+
+void InputFile::collapse_line(char* line) {
+    bool verbatim = strpbrk(line, "$(%;") || line[strspn(line, " \t")] == '[';
+    if (!verbatim) {
+        collapser.lex(line, 0, false);
+    }
+}
+
+Error InputFile::preprocess(const char* defaultFs, const char* path) {
+    SidecarHeader header = {};
+    std::string   outPath;
+    Error         err;
+    try {
+        InputFile   source(defaultFs, path);
+        std::string hash = HashFS::hash(source.fpath(), true);
+        if (hash.length() >= sizeof(header.hash) || !source_mtime(source.fpath(), header.source_mtime)) {
+            return Error::FsFailedRead;
+        }
+        memcpy(header.magic, sidecar_magic, sizeof(header.magic));
+        header.version          = sidecar_version;
+        header.collapse_version = GCodeLexer::collapse_version;
+        header.source_size      = source.size();
+        strcpy(header.hash, hash.c_str());
+
+        outPath = sidecar_path(source.fpath());
+        FileStream out(outPath, "w");
+        out.write((uint8_t*)&header, sizeof(header));
+
+        char line[Channel::maxLine];
+        while ((err = source.readLine(line, Channel::maxLine)) == Error::Ok) {
+            collapse_line(line);
+            if (!*line) {
+                continue;
+            }
+            write_sidecar_record(out, source.lineNumber(), line);
+            ++header.records;
+        }
+        if (err == Error::Eof) {
+            err = Error::Ok;
+            out.set_position(0);
+            out.write((uint8_t*)&header, sizeof(header));
+        }
+    } catch (Error e) { err = e; }
+
+    if (err != Error::Ok && !outPath.empty()) {
+        std::error_code ec;
+        stdfs::remove(outPath, ec);
+    }
+    return err;
+}
+
+bool InputFile::use_preprocessed() {
+    try {
+        auto          sidecar = std::make_unique<FileStream>(sidecar_path(fpath()), "r");
+        SidecarHeader header;
+        int64_t       mtime;
+        if (sidecar->read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+            memcmp(header.magic, sidecar_magic, sizeof(header.magic)) || header.version != sidecar_version ||
+            header.collapse_version != GCodeLexer::collapse_version) {
+            return false;
+        }
+        header.hash[sizeof(header.hash) - 1] = '\0';
+        if (header.source_size != size() || !source_mtime(fpath(), mtime) || mtime != header.source_mtime ||
+            HashFS::hash(fpath(), true) != header.hash) {
+            log_debug("Preprocessed " << name() << " is out of date");
+            return false;
+        }
+        _sidecar = std::move(sidecar);
+        return true;
+    } catch (Error err) { return false; }
+}
+
+Error InputFile::readPreprocessedLine(char* line, int maxlen) {
+    SidecarReader<FileStream> sidecar(*_sidecar);
+    bool                      first = sidecar.position() == 0;
+    uint32_t                  line_number;
+    Error                     err = sidecar.read(line, maxlen, line_number);
+    if (err != Error::Ok) {
+        return err;
+    }
+    _line_number = line_number;
+    if (first) {
+        // Blank lines are not recorded, so all lines before the first record were blank
+        _blank_lines = line_number - 1;
+    }
+    return Error::Ok;
+}
+
+size_t InputFile::position() {
+    return _sidecar ? SidecarReader<FileStream>(*_sidecar).position() : FileStream::position();
+}
+
+void InputFile::set_position(size_t pos) {
+    if (_sidecar) {
+        SidecarReader<FileStream>(*_sidecar).set_position(pos);
+    } else {
+        FileStream::set_position(pos);
+    }
+}
+
+void InputFile::save() {
+    if (_sidecar) {
+        _sidecar->save();
+    }
+    FileStream::save();
+}
+
+void InputFile::restore() {
+    FileStream::restore();
+    if (_sidecar) {
+        _sidecar->restore();
+    }
+}
+
 /*
   Read a line from the file
   Returns Error::Ok if a line was read, even if the line was empty.
@@ -13,6 +152,9 @@ InputFile::InputFile(const char* defaultFs, const char* path) : FileStream(path,
   Returns other Error code on error, after displaying a message.
 */
 Error InputFile::readLine(char* line, int maxlen) {
+    if (_sidecar) {
+        return readPreprocessedLine(line, maxlen);
+    }
     int len = 0;
     int c;
     while ((c = read()) >= 0) {
@@ -82,7 +224,8 @@ Error InputFile::pollLine(char* line) {
     }
     switch (auto err = readLine(line, Channel::maxLine)) {
         case Error::Ok: {
-            float percent_complete = ((float)position()) * 100.0f / size();
+            size_t total            = _sidecar ? SidecarReader<FileStream>(*_sidecar).size() : size();
+            float  percent_complete = ((float)position()) * 100.0f / total;
 
             std::ostringstream s;
             s << "SD:" << std::fixed << std::setprecision(2) << percent_complete << "," << path().c_str();
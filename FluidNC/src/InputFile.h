@@ -8,6 +8,7 @@
 //  - For reporting the progress of GCode execution, counts the number of lines read and
 //    the percentage of the file size that has currently been read.
 //  - For reporting status, remembers the I/O channel that started the process of using the file.
+//  - Optionally reads from a preprocessed sidecar file instead of the GCode text - see preprocess().
 // FileStream's Channel member is not that same Channel that FileStream ultimately
 // inherits from; rather it is a separate channel that is use for status reporting.
 
@@ -18,6 +19,7 @@
 #include "Error.h"
 
 #include <cstdint>
+#include <memory>
 
 class InputFile : public FileStream {
 private:
@@ -26,6 +28,11 @@ private:
 
     size_t _blank_lines = 0;
 
+    // The preprocessed form of the file, when use_preprocessed() accepts it
+    std::unique_ptr<FileStream> _sidecar;
+
+    Error readPreprocessedLine(char* line, int maxlen);
+
 public:
     // fsname is the default file system on which the file is located, in case the path does not specify
     // path is the full path to the file
@@ -47,6 +54,33 @@ public:
 
     Error readLine(char* line, int len);
 
+    // preprocess() writes a sidecar file next to a GCode file, holding its
+    // lines already collapsed - without whitespace and comments, in upper
+    // case - with their line numbers.  Blank lines are left out.  Lines
+    // whose meaning depends on their exact text, such as $ commands and
+    // comments that may contain messages, are kept as they are.
+    // The sidecar records the size and modification time of the GCode
+    // file, so it is ignored once the GCode file changes.
+    static Error preprocess(const char* fsname, const char* path);
+
+    // discard_preprocessed() deletes the sidecar of a file that the firmware
+    // has written, deleted or renamed
+    static void discard_preprocessed(const std::filesystem::path& fpath);
+
+    // collapse_line() edits a line the way preprocess() stores it
+    static void collapse_line(char* line);
+
+    // use_preprocessed() switches reading to the sidecar if it is valid
+    // for the current contents of the file, returning false if not.
+    bool use_preprocessed();
+
+    // When reading from the sidecar, positions are sidecar positions counted
+    // from the first record, so set_position(0) rewinds to the first line
+    size_t position() override;
+    void   set_position(size_t pos) override;
+    void   save() override;
+    void   restore() override;
+
     // Channel methods
     size_t write(uint8_t c) override { return 0; }
     void   ack(Error status) override;
@@ -10,6 +10,7 @@
 JSONencoder::JSONencoder(bool encapsulate, Channel* channel) :
     _encapsulate(encapsulate), level(0), _str(&linebuf), _channel(channel), category("nvs") {
     count[level] = 0;
+    linebuf.reserve(chunk_size);
 }
 
 JSONencoder::JSONencoder(std::string* str) : level(0), _str(str), category("nvs") {
@@ -29,7 +30,7 @@ void JSONencoder::flush() {
 }
 void JSONencoder::add(char c) {
     (*_str) += c;
-    if (_channel && (*_str).length() >= 100) {
+    if (_channel && (*_str).length() >= chunk_size) {
         flush();
     }
 }
@@ -234,7 +235,9 @@ void JSONencoder::member(const char* tag, const std::string& value) {
 
 // Creates a "tag":"value" member from an integer
 void JSONencoder::member(const char* tag, int value) {
-    member(tag, std::to_string(value));
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%d", value);
+    member(tag, buf);
 }
 
 // Creates an Esp32_WebUI configuration item specification from
@@ -256,7 +259,9 @@ void JSONencoder::begin_webui(const char* name, const char* help, const char* ty
 // Creates an Esp32_WebUI configuration item specification from
 // an integer value.
 void JSONencoder::begin_webui(const char* brief, const char* full, const char* type, int val) {
-    begin_webui(brief, full, type, std::to_string(val).c_str());
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%d", val);
+    begin_webui(brief, full, type, buf);
 }
 
 // Creates an Esp32_WebUI configuration item specification from
@@ -281,5 +286,7 @@ void JSONencoder::id_value_object(const char* id, const std::string& value) {
 }
 
 void JSONencoder::id_value_object(const char* id, int value) {
-    id_value_object(id, std::to_string(value));
+    char buf[12];
+    snprintf(buf, sizeof(buf), "%d", value);
+    id_value_object(id, buf);
 }
@@ -22,7 +22,10 @@ private:
 
     void quoted(const char* s);
 
-    std::string linebuf;
+    // Output to a channel is sent in pieces of at most chunk_size characters,
+    // so the whole document is never held in memory.
+    static const size_t chunk_size = 100;
+    std::string         linebuf;
 
     std::string* _str     = nullptr;
     Channel*     _channel = nullptr;
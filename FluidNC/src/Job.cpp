@@ -4,9 +4,270 @@
 #include "Job.h"
 #include <map>
 #include <stack>
+#include <algorithm>
+#include <cstring>
 
 std::stack<JobSource*> job;
 
+bool LineRun::append(size_t position, size_t end_position, size_t line_number, const char* line, size_t max_text) {
+    size_t len = strlen(line);
+    if (text.length() + len + 1 > max_text) {
+        return false;
+    }
+    lines.push_back({ position, line_number, text.length() });
+    text.append(line, len + 1);
+    end = end_position;
+    return true;
+}
+
+bool LineRun::find(size_t position, size_t& index) {
+    if (lines.empty() || position < lines.front().position || position >= end) {
+        return false;
+    }
+    auto it = std::lower_bound(lines.begin(), lines.end(), position, [](const Line& l, size_t pos) { return l.position < pos; });
+    if (it == lines.end() || it->position != position) {
+        return false;
+    }
+    index = it - lines.begin();
+    return true;
+}
+
+void LineRun::clear() {
+    lines.clear();
+    text.clear();
+    end = 0;
+}
+
+size_t JobSource::position() {
+    if (_run) {
+        return _run->lines[_replay].position;
+    }
+    return _seek_pending ? _seek_to : _channel->position();
+}
+
+void JobSource::replay(LineRun& run, size_t index) {
+    _run          = &run;
+    _replay       = index;
+    _seek_pending = false;
+}
+
+void JobSource::seek(size_t pos) {
+    _run          = nullptr;
+    _seek_pending = true;
+    _seek_to      = pos;
+}
+
+// Apply a pending jump to the file
+void JobSource::sync() {
+    if (_seek_pending) {
+        _seek_pending = false;
+        if (_channel->position() != _seek_to) {
+            _channel->set_position(_seek_to);
+        }
+    }
+}
+
+void JobSource::set_position(size_t pos) {
+    size_t index;
+    if (_loop.find(pos, index)) {
+        replay(_loop, index);
+        return;
+    }
+    for (auto& body : _bodies) {
+        if (body.run.find(pos, index)) {
+            body.last_used = ++_clock;
+            replay(body.run, index);
+            return;
+        }
+    }
+    seek(pos);
+}
+
+Error JobSource::pollLine(char* line) {
+    if (_run) {
+        auto& l = _run->lines[_replay];
+        strcpy(line, _run->text.c_str() + l.offset);
+        _channel->_line_number = l.line_number;
+        if (++_replay == _run->lines.size()) {
+            // Continue from the file after the end of the run
+            seek(_run->end);
+        }
+        return Error::Ok;
+    }
+    sync();
+    bool recording = (_open_loops && !_loop_full) || _body_recording;
+    if (!recording) {
+        return _channel->pollLine(line);
+    }
+    size_t start = _channel->position();
+    Error  err   = _channel->pollLine(line);
+    if (err == Error::Ok) {
+        size_t end = _channel->position();
+        // If the channel does not track positions, there is nothing to go back to
+        if (end > start) {
+            record(start, end, line);
+        }
+    }
+    return err;
+}
+
+void JobSource::record(size_t position, size_t end, const char* line) {
+    if (_open_loops && !_loop_full) {
+        if (!_loop.empty() && position != _loop.end) {
+            _loop.clear();
+        }
+        if (!_loop.append(position, end, _channel->_line_number, line, max_loop_text)) {
+            // Too big - fall back to re-reading the file until the loops close
+            _loop.clear();
+            _loop_full = true;
+        }
+    }
+    if (_body_recording) {
+        if (position != _body.end || !_body.append(position, end, _channel->_line_number, line, max_body_text)) {
+            _body.clear();
+            _body_recording = false;
+        }
+    }
+}
+
+void JobSource::end_loop() {
+    if (_open_loops && --_open_loops == 0) {
+        if (_run == &_loop) {
+            // Resume reading the file where the replay left off
+            auto& l                = _loop.lines[_replay];
+            _channel->_line_number = l.line_number - 1;
+            seek(l.position);
+        }
+        _loop.clear();
+        _loop.lines.shrink_to_fit();
+        _loop.text.shrink_to_fit();
+        _loop_full = false;
+    }
+}
+
+// Recognizes O<n> SUB lines, ignoring case, spaces and trailing comments
+static bool is_subroutine_definition(const char* line, uint32_t& label) {
+    auto skip_spaces = [&]() {
+        while (isspace(*line)) {
+            ++line;
+        }
+    };
+    skip_spaces();
+    if (toupper(*line++) != 'O') {
+        return false;
+    }
+    skip_spaces();
+    if (!isdigit(*line)) {
+        return false;
+    }
+    label = 0;
+    while (isdigit(*line) || isspace(*line)) {
+        if (isdigit(*line)) {
+            label = label * 10 + (*line - '0');
+        }
+        ++line;
+    }
+    for (const char* sub = "SUB"; *sub; ++sub, ++line) {
+        if (toupper(*line) != *sub) {
+            return false;
+        }
+    }
+    skip_spaces();
+    return *line == '\0' || *line == '(' || *line == ';';
+}
+
+void JobSource::define_subroutine(uint32_t label) {
+    _subroutines.emplace(label, Subroutine { position(), _channel->_line_number });
+}
+
+// Index every subroutine in the file, so forward calls can be found
+void JobSource::scan_subroutines() {
+    _scanned = true;
+
+    size_t      resume      = position();
+    size_t      line_number = _channel->_line_number;
+    std::string progress    = _channel->_progress;
+
+    _channel->set_position(0);
+    _channel->_line_number = 0;
+
+    char   line[Channel::maxLine];
+    size_t last = 0;
+    while (_channel->pollLine(line) == Error::Ok) {
+        size_t pos = _channel->position();
+        if (pos <= last) {
+            break;  // The channel does not track positions
+        }
+        last = pos;
+        uint32_t label;
+        if (is_subroutine_definition(line, label)) {
+            _subroutines.emplace(label, Subroutine { pos, _channel->_line_number });
+        }
+    }
+
+    _channel->_line_number = line_number;
+    _channel->_progress    = progress;
+    if (!_run) {
+        seek(resume);
+    }
+    // If a run is being replayed, the jump to its end restores the file position
+}
+
+bool JobSource::call_subroutine(uint32_t label) {
+    _body.clear();
+    _body_recording = false;
+
+    for (auto& body : _bodies) {
+        if (body.label == label && !body.run.empty()) {
+            body.last_used = ++_clock;
+            replay(body.run, 0);
+            return true;
+        }
+    }
+
+    auto it = _subroutines.find(label);
+    if (it == _subroutines.end() && !_scanned) {
+        scan_subroutines();
+        it = _subroutines.find(label);
+    }
+    if (it == _subroutines.end()) {
+        return false;
+    }
+    auto& sub              = it->second;
+    _channel->_line_number = sub.line_number;
+    seek(sub.position);
+
+    // Record the body as it is read, to serve later calls from memory
+    _body.end       = sub.position;
+    _body_label     = label;
+    _body_recording = true;
+    return true;
+}
+
+void JobSource::return_subroutine(uint32_t label) {
+    if (_body_recording && _body_label == label && !_body.empty()) {
+        // Replace the least recently used body
+        CachedBody* slot = &_bodies[0];
+        for (auto& body : _bodies) {
+            if (body.run.empty()) {
+                slot = &body;
+                break;
+            }
+            if (body.last_used < slot->last_used) {
+                slot = &body;
+            }
+        }
+        if (_run == &slot->run) {
+            seek(position());
+        }
+        slot->label     = label;
+        slot->last_used = ++_clock;
+        slot->run       = std::move(_body);
+    }
+    _body.clear();
+    _body_recording = false;
+}
+
 Channel* Job::leader = nullptr;
 
 bool Job::active() {
@@ -59,13 +320,13 @@ void Job::abort() {
     }
 }
 
-bool Job::get_param(const std::string& name, float& value) {
+bool Job::get_param(param_name_t name, float& value) {
     return job.top()->get_param(name, value);
 }
-bool Job::set_param(const std::string& name, float value) {
+bool Job::set_param(param_name_t name, float value) {
     return job.top()->set_param(name, value);
 }
-bool Job::param_exists(const std::string& name) {
+bool Job::param_exists(param_name_t name) {
     return job.top()->param_exists(name);
 }
 Channel* Job::channel() {
@@ -2,33 +2,119 @@
 // Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
 
 #include "Channel.h"
+#include "ParamNames.h"
 #include <stack>
+#include <vector>
+
+// A run of consecutive lines from a job file, kept in memory so they can
+// be replayed without reading the file again.  Positions are file positions,
+// so flow control can jump to a line with set_position() whether or not it
+// is cached.
+struct LineRun {
+    struct Line {
+        size_t position;     // File position of the start of the line
+        size_t line_number;  // Channel line number after reading the line
+        size_t offset;       // Offset of the text in text
+    };
+    std::vector<Line> lines;
+    std::string       text;
+    size_t            end = 0;  // File position after the last line
+
+    // append() returns false if the text would exceed max_text
+    bool append(size_t position, size_t end_position, size_t line_number, const char* line, size_t max_text);
+    bool find(size_t position, size_t& index);
+    bool empty() { return lines.empty(); }
+    void clear();
+};
 
 class JobSource {
 private:
-    Channel*                     _channel;
-    std::map<std::string, float> _local_params;
+    Channel*    _channel;
+    ParamValues _local_params;
+
+    // While a flow control loop is open, the lines that are read from the
+    // channel are kept in _loop, so that later passes through the loop
+    // body are replayed from RAM instead of seeking back in the file and
+    // reading it again.
+    static constexpr size_t max_loop_text = 8192;
+
+    LineRun _loop;
+    int     _open_loops = 0;
+    bool    _loop_full  = false;  // The loop body is too large to cache
+
+    // Subroutine bodies start after their O<n> SUB line.  Definitions are
+    // indexed as they are passed, and the first call to a subroutine that
+    // has not been seen yet scans the whole file once.  The bodies of the
+    // most recently called subroutines are kept in memory.
+    struct Subroutine {
+        size_t position;
+        size_t line_number;
+    };
+    struct CachedBody {
+        uint32_t label;
+        uint32_t last_used;
+        LineRun  run;
+    };
+    static constexpr int    max_bodies    = 4;
+    static constexpr size_t max_body_text = 2048;
+
+    std::map<uint32_t, Subroutine> _subroutines;
+    bool                           _scanned = false;
+    CachedBody                     _bodies[max_bodies];
+    uint32_t                       _clock = 0;
+    LineRun                        _body;  // Body being recorded by the current call
+    uint32_t                       _body_label;
+    bool                           _body_recording = false;
+
+    // The run that is being replayed, if any
+    LineRun* _run    = nullptr;
+    size_t   _replay = 0;
+
+    // Jumps that leave the cached lines are applied to the file when the
+    // next line is read from it, so a jump that lands in a cached run
+    // never touches the file.
+    bool   _seek_pending = false;
+    size_t _seek_to      = 0;
+
+    void replay(LineRun& run, size_t index);
+    void seek(size_t pos);
+    void sync();
+    void record(size_t position, size_t end, const char* line);
+    void scan_subroutines();
 
 public:
     JobSource(Channel* channel) : _channel(channel) {}
-    bool get_param(const std::string& name, float& value) {
-        auto it = _local_params.find(name);
-        if (it == _local_params.end()) {
-            return false;
-        }
-        value = it->second;
-        return true;
-    }
-    bool set_param(const std::string& name, float value) {
-        _local_params[name] = value;
+    bool get_param(param_name_t name, float& value) { return _local_params.get(name, value); }
+    bool set_param(param_name_t name, float value) {
+        _local_params.set(name, value);
         return true;
     }
-    bool param_exists(const std::string& name) { return _local_params.count(name) != 0; }
+    bool param_exists(param_name_t name) { return _local_params.exists(name); }
 
-    void   save() { _channel->save(); }
+    void save() {
+        sync();
+        _channel->save();
+    }
     void   restore() { _channel->restore(); }
-    size_t position() { return _channel->position(); }
-    void   set_position(size_t pos) { _channel->set_position(pos); }
+    size_t position();
+    void   set_position(size_t pos);
+
+    // pollLine() returns the next line, from a cached run when replaying
+    // or else from the channel.
+    Error pollLine(char* line);
+
+    // Flow control calls these when a loop that can jump back is entered
+    // and when it is left.  The loop cache is kept while any loop is open.
+    void begin_loop() { ++_open_loops; }
+    void end_loop();
+
+    // define_subroutine() records the body of a subroutine whose O<n> SUB
+    // line was just read.  call_subroutine() jumps to the start of the body,
+    // returning false if the subroutine is not defined in this file.  The
+    // caller jumps back with set_position() after return_subroutine().
+    void define_subroutine(uint32_t label);
+    bool call_subroutine(uint32_t label);
+    void return_subroutine(uint32_t label);
 
     Channel* channel() { return _channel; }
 
@@ -51,8 +137,8 @@ public:
     static void       abort();
     static JobSource* source();
 
-    static bool     get_param(const std::string& name, float& value);
-    static bool     set_param(const std::string& name, float value);
-    static bool     param_exists(const std::string& name);
+    static bool     get_param(param_name_t name, float& value);
+    static bool     set_param(param_name_t name, float value);
+    static bool     param_exists(param_name_t name);
     static Channel* channel();
 };
@@ -0,0 +1,199 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "JobAnalyzer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// The same constants as the planner
+static const float minimum_feed_rate = 1.0f;     // mm/min
+static const float some_large_value  = 1.0e38f;  // Junction speed of a straight line
+static const float sec_per_min_sq    = 60.0f * 60.0f;
+
+JobAnalyzer::JobAnalyzer(const Limits& limits, const float* position) : _limits(limits) {
+    if (_limits.n_axis > max_axes) {
+        _limits.n_axis = max_axes;
+    }
+    memcpy(_position, position, _limits.n_axis * sizeof(float));
+    memset(_unit_vec, 0, sizeof(_unit_vec));
+    // The planner ring buffer keeps one block empty
+    _window.resize(std::max(_limits.planner_blocks, size_t(2)) - 1);
+}
+
+void JobAnalyzer::move(const float* target, float feed_rate, bool rapid, bool inverse_time) {
+    auto  n_axis = _limits.n_axis;
+    float unit_vec[max_axes];
+    float millimeters = 0;
+    for (size_t i = 0; i < n_axis; i++) {
+        unit_vec[i] = target[i] - _position[i];
+        millimeters += unit_vec[i] * unit_vec[i];
+    }
+    millimeters = sqrtf(millimeters);
+    if (millimeters == 0) {
+        // The planner drops zero-length moves
+        return;
+    }
+
+    // Limit the rate and acceleration along the line so no axis exceeds its own
+    float acceleration = some_large_value;
+    float rapid_rate   = some_large_value;
+    for (size_t i = 0; i < n_axis; i++) {
+        unit_vec[i] /= millimeters;
+        if (unit_vec[i] != 0) {
+            acceleration = std::min(acceleration, fabsf(_limits.acceleration[i] / unit_vec[i]));
+            rapid_rate   = std::min(rapid_rate, fabsf(_limits.max_rate[i] / unit_vec[i]));
+        }
+    }
+    acceleration *= sec_per_min_sq;
+
+    float nominal_speed = rapid_rate;
+    if (!rapid) {
+        nominal_speed = inverse_time ? feed_rate * millimeters : feed_rate;
+        if (nominal_speed > rapid_rate) {
+            nominal_speed = rapid_rate;
+            ++_rate_limited;
+        }
+    }
+    nominal_speed = std::max(nominal_speed, minimum_feed_rate);
+
+    // Junction speed by the centripetal acceleration approximation, as in plan_buffer_line()
+    float max_junction_speed_sqr = 0;
+    if (!_at_rest) {
+        float junction_unit_vec[max_axes];
+        float junction_cos_theta = 0;
+        for (size_t i = 0; i < n_axis; i++) {
+            junction_cos_theta -= _unit_vec[i] * unit_vec[i];
+            junction_unit_vec[i] = unit_vec[i] - _unit_vec[i];
+        }
+        if (junction_cos_theta > 0.999999f) {
+            max_junction_speed_sqr = 0;
+        } else if (junction_cos_theta < -0.999999f) {
+            max_junction_speed_sqr = some_large_value;
+        } else {
+            float length = 0;
+            for (size_t i = 0; i < n_axis; i++) {
+                length += junction_unit_vec[i] * junction_unit_vec[i];
+            }
+            length                      = sqrtf(length);
+            float junction_acceleration = some_large_value;
+            for (size_t i = 0; i < n_axis; i++) {
+                if (junction_unit_vec[i] != 0) {
+                    junction_acceleration = std::min(junction_acceleration, fabsf(_limits.acceleration[i] * length / junction_unit_vec[i]));
+                }
+            }
+            junction_acceleration *= sec_per_min_sq;
+
+            float sin_theta_d2     = sqrtf(0.5f * (1.0f - junction_cos_theta));  // Trig half angle identity
+            max_junction_speed_sqr = (junction_acceleration * _limits.junction_deviation * sin_theta_d2) / (1.0f - sin_theta_d2);
+        }
+    }
+
+    // The planner waits for room by letting the oldest block run
+    if (_count == _window.size()) {
+        plan();
+        retire();
+    }
+
+    float  entry_limit    = _at_rest ? 0 : std::min(nominal_speed, _previous_nominal_speed);
+    Block& b              = block(_count++);
+    b.millimeters         = millimeters;
+    b.acceleration        = acceleration;
+    b.nominal_speed       = nominal_speed;
+    b.max_entry_speed_sqr = std::min(entry_limit * entry_limit, max_junction_speed_sqr);
+    b.entry_speed_sqr     = _count == 1 ? 0 : b.max_entry_speed_sqr;  // A block alone in the window starts at rest
+
+    _previous_nominal_speed = nominal_speed;
+    _at_rest                = false;
+    memcpy(_unit_vec, unit_vec, sizeof(unit_vec));
+    memcpy(_position, target, n_axis * sizeof(float));
+    ++_moves;
+}
+
+// Reverse pass from the newest block, which ends at rest.  The entry speed
+// of the oldest block was fixed when the block before it was retired.
+void JobAnalyzer::plan() {
+    float exit_speed_sqr = 0;
+    for (size_t i = _count; i-- > 1;) {
+        Block& b          = block(i);
+        b.entry_speed_sqr = std::min(b.max_entry_speed_sqr, exit_speed_sqr + 2 * b.acceleration * b.millimeters);
+        exit_speed_sqr    = b.entry_speed_sqr;
+    }
+}
+
+// Adds the time of the oldest block, whose exit speed is the smaller of
+// the planned entry speed of the next block and the speed it can reach by
+// accelerating over its length.
+void JobAnalyzer::retire() {
+    Block& b             = block(0);
+    float  a             = b.acceleration;
+    float  entry_sqr     = b.entry_speed_sqr;
+    float  exit_sqr      = 0;
+    float  reachable_sqr = entry_sqr + 2 * a * b.millimeters;
+    if (_count > 1) {
+        exit_sqr = std::min(block(1).entry_speed_sqr, reachable_sqr);
+    }
+
+    // Trapezoid, or triangle if the block is too short to reach nominal speed
+    float nominal_sqr = b.nominal_speed * b.nominal_speed;
+    float peak_sqr    = std::min(nominal_sqr, 0.5f * (reachable_sqr + exit_sqr));
+    if (peak_sqr < 0.98f * nominal_sqr) {
+        ++_accel_limited;
+    }
+    float peak     = sqrtf(peak_sqr);
+    float entry    = sqrtf(entry_sqr);
+    float exit     = sqrtf(exit_sqr);
+    float ramps    = (2 * peak_sqr - entry_sqr - exit_sqr) / (2 * a);
+    float cruising = std::max(b.millimeters - ramps, 0.0f);
+    _minutes += (2 * peak - entry - exit) / a + cruising / peak;
+
+    _head = (_head + 1) % _window.size();
+    if (--_count) {
+        block(0).entry_speed_sqr = exit_sqr;
+    }
+}
+
+void JobAnalyzer::finish() {
+    while (_count) {
+        plan();
+        retire();
+    }
+    _at_rest = true;
+}
+
+void JobAnalyzer::dwell(float seconds) {
+    finish();
+    _dwell_seconds += seconds;
+}
+
+void JobAnalyzer::check(const float* target, int32_t line_number) {
+    bool violation = false;
+    for (size_t i = 0; i < _limits.n_axis; i++) {
+        float coordinate = target[i];
+        if (!_have_bounds) {
+            _min[i] = _max[i] = coordinate;
+        } else {
+            _min[i] = std::min(_min[i], coordinate);
+            _max[i] = std::max(_max[i], coordinate);
+        }
+        if (_limits.soft_limits[i] && (coordinate < _limits.min_position[i] || coordinate > _limits.max_position[i])) {
+            violation = true;
+        }
+    }
+    _have_bounds = true;
+    if (violation) {
+        if (!_violations++) {
+            _first_violation_line = line_number;
+        }
+    }
+}
+
+bool JobAnalyzer::bounds(float* min, float* max) const {
+    if (!_have_bounds) {
+        return false;
+    }
+    memcpy(min, _min, _limits.n_axis * sizeof(float));
+    memcpy(max, _max, _limits.n_axis * sizeof(float));
+    return true;
+}
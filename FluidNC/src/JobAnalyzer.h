@@ -0,0 +1,96 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// JobAnalyzer estimates how long a job will take without moving the machine.
+// In check mode, motion control passes it each move after kinematics, and it
+// plans their velocities the way the planner would - junction speeds from
+// junction deviation, then reverse and forward passes over a window as deep
+// as the planner buffer, assuming the buffer is kept full.  The time of each
+// move is that of its trapezoidal speed profile.
+//
+// It also collects the bounding box of the moves, and counts the moves that
+// would violate soft limits, which in check mode would otherwise stop the job.
+//
+// The analyzer has no dependencies on the rest of the firmware, so it can be
+// tested on the host.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class JobAnalyzer {
+public:
+    static const size_t max_axes = 6;
+
+    // Machine limits, in the units of the machine configuration
+    struct Limits {
+        size_t n_axis;
+        float  max_rate[max_axes];      // mm/min
+        float  acceleration[max_axes];  // mm/sec^2
+        float  min_position[max_axes];
+        float  max_position[max_axes];
+        bool   soft_limits[max_axes];
+        float  junction_deviation;  // mm
+        size_t planner_blocks;
+    };
+
+    JobAnalyzer(const Limits& limits, const float* position);
+
+    // A move in motor space.  feed_rate is in mm/min, or moves/min if inverse_time.
+    void move(const float* target, float feed_rate, bool rapid, bool inverse_time);
+
+    // Checks a cartesian target against the soft limits and the bounding box
+    void check(const float* target, int32_t line_number);
+
+    // A dwell waits for the moves before it to finish
+    void dwell(float seconds);
+
+    // Plans the moves still in the window, ending at rest
+    void finish();
+
+    float    seconds() const { return float((_minutes + _dwell_seconds / 60.0) * 60.0); }
+    uint32_t moves() const { return _moves; }
+    uint32_t rate_limited() const { return _rate_limited; }    // Feed rate above what the axes allow
+    uint32_t accel_limited() const { return _accel_limited; }  // Too short to reach the feed rate
+    uint32_t violations() const { return _violations; }
+    int32_t  first_violation_line() const { return _first_violation_line; }
+    bool     bounds(float* min, float* max) const;
+
+private:
+    struct Block {
+        float millimeters;
+        float acceleration;         // mm/min^2
+        float nominal_speed;        // mm/min
+        float max_entry_speed_sqr;  // Limited by the junction and nominal speeds
+        float entry_speed_sqr;      // Planned entry speed
+    };
+
+    Limits _limits;
+    float  _position[max_axes];
+    float  _unit_vec[max_axes];  // Direction of the previous move
+    bool   _at_rest = true;
+    float  _previous_nominal_speed;
+
+    // The planning window, oldest first
+    std::vector<Block> _window;
+    size_t             _head  = 0;  // Index of the oldest block
+    size_t             _count = 0;
+
+    double   _minutes       = 0;
+    double   _dwell_seconds = 0;
+    uint32_t _moves         = 0;
+    uint32_t _rate_limited  = 0;
+    uint32_t _accel_limited = 0;
+
+    float    _min[max_axes];
+    float    _max[max_axes];
+    bool     _have_bounds          = false;
+    uint32_t _violations           = 0;
+    int32_t  _first_violation_line = -1;
+
+    Block& block(size_t i) { return _window[(_head + i) % _window.size()]; }
+    void   plan();
+    void   retire();
+};
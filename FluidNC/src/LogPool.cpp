@@ -0,0 +1,119 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "LogPool.h"
+
+#include <cstring>
+
+LogBuffer LogPool::_buffers[LogPool::n_buffers];
+
+std::atomic<uint32_t> LogPool::_seq(0);
+std::atomic<uint32_t> LogPool::_drops(0);
+std::atomic<uint32_t> LogPool::_heap_fallbacks(0);
+int                   LogPool::_high_water = 0;
+
+static constexpr uint32_t state_mask = 3;
+
+static inline uint32_t with_state(uint32_t tag, uint32_t state) {
+    return (tag & ~state_mask) | state;
+}
+static inline uint32_t next_generation(uint32_t tag, uint32_t state) {
+    return ((tag & ~state_mask) + (state_mask + 1)) | state;
+}
+
+bool LogBuffer::append(const uint8_t* data, size_t length) {
+    if (length > room()) {
+        return false;
+    }
+    memcpy(text + len, data, length);
+    len += length;
+    return true;
+}
+
+LogBuffer* LogPool::acquire(MsgLevel level) {
+    LogBuffer* buf = nullptr;
+    for (auto& b : _buffers) {
+        uint32_t tag = b.tag.load();
+        if ((tag & state_mask) == Free && b.tag.compare_exchange_strong(tag, with_state(tag, Filling))) {
+            buf = &b;
+            break;
+        }
+    }
+    if (!buf) {
+        buf = steal_oldest();
+        if (!buf) {
+            return nullptr;
+        }
+    }
+    buf->len   = 0;
+    buf->level = level;
+
+    int used = in_use();
+    if (used > _high_water) {
+        _high_water = used;
+    }
+    return buf;
+}
+
+// Reclaim the buffer of the oldest queued message at the most verbose
+// level that is present, so debug chatter goes before errors do.
+LogBuffer* LogPool::steal_oldest() {
+    // A few retries cover the case where the output task claims the
+    // chosen victim between the scan and the compare-exchange.
+    for (int tries = 0; tries < 3; ++tries) {
+        LogBuffer* victim = nullptr;
+        uint32_t   tag    = 0;
+        for (auto& b : _buffers) {
+            uint32_t t = b.tag.load();
+            if ((t & state_mask) != Queued || b.level == MsgLevelNone) {
+                continue;
+            }
+            if (!victim || b.level > victim->level || (b.level == victim->level && int32_t(b.seq - victim->seq) < 0)) {
+                victim = &b;
+                tag    = t;
+            }
+        }
+        if (!victim) {
+            return nullptr;
+        }
+        // Bumping the generation invalidates the ticket that is still in
+        // message_queue, so output_loop() will skip the stale entry.
+        if (victim->tag.compare_exchange_strong(tag, next_generation(tag, Filling))) {
+            ++_drops;
+            return victim;
+        }
+    }
+    return nullptr;
+}
+
+uint32_t LogPool::queue(LogBuffer* buf) {
+    buf->text[buf->len++] = '\n';
+    buf->text[buf->len]   = '\0';
+    buf->seq              = _seq++;
+
+    uint32_t tag = with_state(buf->tag.load(), Queued);
+    buf->tag.store(tag);
+    return tag;
+}
+
+bool LogPool::claim(LogBuffer* buf, uint32_t ticket) {
+    return buf->tag.compare_exchange_strong(ticket, with_state(ticket, Printing));
+}
+
+void LogPool::release(LogBuffer* buf) {
+    buf->tag.store(next_generation(buf->tag.load(), Free));
+}
+
+bool LogPool::withdraw(LogBuffer* buf, uint32_t ticket) {
+    return buf->tag.compare_exchange_strong(ticket, next_generation(ticket, Free));
+}
+
+int LogPool::in_use() {
+    int n = 0;
+    for (auto& b : _buffers) {
+        if ((b.tag.load() & state_mask) != Free) {
+            ++n;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,98 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// LogPool is a fixed set of preallocated message buffers for LogStream.
+// A LogStream formats its message directly into a pool buffer, which
+// is then handed to the output task through message_queue and returned
+// to the pool after it has been printed.  That replaces the std::string
+// that used to be allocated for every message and deleted by output_loop(),
+// so heavy logging no longer churns - and fragments - the heap.
+//
+// When every buffer is in use, the oldest message that is still waiting
+// in the queue is dropped and its buffer is reused.  Only log messages
+// (error, warn, info, debug, verbose) are candidates for dropping;
+// MsgLevelNone messages carry protocol data like status reports and
+// setting values, so they are never discarded.  If no buffer can be
+// found, LogStream falls back to a heap-allocated std::string.
+
+#include "Config.h"  // MAX_MESSAGE_LINE
+#include "Logging.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+struct LogBuffer {
+    static constexpr size_t capacity = MAX_MESSAGE_LINE;
+
+    // Room is reserved for a closing ']', the newline that LogPool::queue()
+    // appends, and the null terminator.
+    static constexpr size_t max_text = capacity - 3;
+
+    char     text[capacity];
+    size_t   len;
+    MsgLevel level;
+    uint32_t seq;  // Order of submission, used to find the oldest queued buffer
+
+    // The low bits hold the State and the rest is a generation count that
+    // changes each time the buffer is recycled.  A queued message carries
+    // the tag value, so the output task can tell if the buffer was
+    // dropped and reused after the message was queued.
+    std::atomic<uint32_t> tag;
+
+    bool   append(const uint8_t* data, size_t length);
+    size_t room() { return capacity - 2 - len; }
+};
+
+class LogPool {
+public:
+    static constexpr int n_buffers = 16;
+
+    enum State : uint32_t {
+        Free     = 0,
+        Filling  = 1,
+        Queued   = 2,
+        Printing = 3,
+    };
+
+    // acquire() returns an empty buffer in the Filling state, or nullptr
+    // if the pool is exhausted and no queued message can be dropped.
+    static LogBuffer* acquire(MsgLevel level);
+
+    // queue() terminates a filled buffer with a newline, marks it as Queued
+    // and returns the ticket that the output task must present to claim() it.
+    // From then on the buffer is immutable, so the output task can hand the
+    // same text to every destination of a broadcast message.
+    static uint32_t queue(LogBuffer* buf);
+
+    // claim() is called by the output task.  It returns false if the
+    // buffer was dropped after the ticket was issued.
+    static bool claim(LogBuffer* buf, uint32_t ticket);
+
+    static void release(LogBuffer* buf);
+
+    // withdraw() frees a queued buffer whose message could not be sent.
+    // It returns false if another task has already dropped the message
+    // and reused the buffer, which then belongs to that task.
+    static bool withdraw(LogBuffer* buf, uint32_t ticket);
+
+    // Statistics
+    static void     count_heap_fallback() { ++_heap_fallbacks; }
+    static void     count_drop() { ++_drops; }
+    static uint32_t drops() { return _drops; }
+    static uint32_t heap_fallbacks() { return _heap_fallbacks; }
+    static int      in_use();
+    static int      high_water() { return _high_water; }
+
+private:
+    static LogBuffer _buffers[n_buffers];
+
+    static std::atomic<uint32_t> _seq;
+    static std::atomic<uint32_t> _drops;
+    static std::atomic<uint32_t> _heap_fallbacks;
+    static int                   _high_water;
+
+    static LogBuffer* steal_oldest();
+};
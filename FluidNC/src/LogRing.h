@@ -0,0 +1,53 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// A ring of log text in storage that belongs to the caller, so the storage
+// and the count can be in RTC RAM and survive a reset.  The count is the
+// total number of bytes ever written, so the write index is len % size.
+// Once the ring wraps, reading starts at the first complete line.
+
+#include <cstddef>
+#include <string>
+
+class LogRing {
+    char*   _buf;
+    size_t  _size;
+    size_t& _len;
+
+public:
+    constexpr LogRing(char* buf, size_t size, size_t& len) : _buf(buf), _size(size), _len(len) {}
+
+    void put(char c) { _buf[_len++ % _size] = c; }
+    void append(const char* s) {
+        while (*s) {
+            put(*s++);
+        }
+    }
+
+    // Calls f with each line, without its line ending
+    template <typename F>
+    void lines(F f) const {
+        size_t i = 0;
+        if (_len > _size) {
+            // The ring has wrapped, so skip the partial oldest line
+            i = _len - _size;
+            while (i < _len && _buf[i++ % _size] != '\n') {}
+        }
+        while (i < _len) {
+            std::string line;
+            while (i < _len) {
+                char c = _buf[i++ % _size];
+                if (c == '\r') {
+                    continue;
+                }
+                if (c == '\n') {
+                    break;
+                }
+                line += c;
+            }
+            f(line);
+        }
+    }
+};
@@ -6,6 +6,7 @@
 #include "Serial.h"
 #include "SettingsDefinitions.h"
 #include "Channel.h"
+#include "LogPool.h"
 
 const EnumItem messageLevels2[] = { { MsgLevelNone, "None" }, { MsgLevelError, "Error" }, { MsgLevelWarning, "Warn" },
                                     { MsgLevelInfo, "Info" }, { MsgLevelDebug, "Debug" }, { MsgLevelVerbose, "Verbose" },
@@ -16,7 +17,11 @@ bool atMsgLevel(MsgLevel level) {
 }
 
 LogStream::LogStream(Channel& channel, MsgLevel level) : _channel(channel), _level(level) {
-    _line = new std::string();
+    _buf = LogPool::acquire(level);
+    if (!_buf) {
+        LogPool::count_heap_fallback();
+        _line = new std::string();
+    }
 }
 
 LogStream::LogStream(Channel& channel, MsgLevel level, const char* name) : LogStream(channel, level) {
@@ -26,12 +31,39 @@ LogStream::LogStream(Channel& channel, MsgLevel level, const char* name) : LogSt
 LogStream::LogStream(Channel& channel, const char* name) : LogStream(channel, MsgLevelNone, name) {}
 LogStream::LogStream(MsgLevel level, const char* name) : LogStream(allChannels, level, name) {}
 
+// Move the message to a heap string when it outgrows the pool buffer.
+void LogStream::spill() {
+    LogPool::count_heap_fallback();
+    _line = new std::string(_buf->text, _buf->len);
+    LogPool::release(_buf);
+    _buf = nullptr;
+}
+
 size_t LogStream::write(uint8_t c) {
-    *_line += (char)c;
-    return 1;
+    return write(&c, 1);
+}
+
+size_t LogStream::write(const uint8_t* buffer, size_t length) {
+    // Reserve one byte for the closing ']' that the destructor might add
+    if (_buf && length < _buf->room()) {
+        _buf->append(buffer, length);
+        return length;
+    }
+    if (_buf) {
+        spill();
+    }
+    _line->append(reinterpret_cast<const char*>(buffer), length);
+    return length;
 }
 
 LogStream::~LogStream() {
+    if (_buf) {
+        if (_buf->len && _buf->text[0] == '[') {
+            _buf->text[_buf->len++] = ']';
+        }
+        _channel.sendLine(_level, _buf);
+        return;
+    }
     if ((*_line).length() && (*_line)[0] == '[') {
         *_line += ']';
     }
@@ -10,6 +10,7 @@
 #include "Types.h"
 
 class Channel;
+struct LogBuffer;
 
 enum MsgLevel {
     MsgLevelNone    = 0,
@@ -21,10 +22,16 @@ enum MsgLevel {
 };
 
 struct LogMessage {
+    enum class Kind : uint8_t {
+        Fixed,   // line is a const char* that need not be reclaimed
+        String,  // line is a std::string* that must be deleted
+        Pooled,  // line is a LogBuffer* that must be released to LogPool
+    };
     Channel* channel;
     void*    line;
     MsgLevel level;
-    bool     isString;
+    Kind     kind;
+    uint32_t ticket;  // For Pooled messages, see LogPool::claim()
 };
 
 extern TaskHandle_t outputTask;
@@ -40,7 +47,9 @@ extern const EnumItem messageLevels2[];
 // - But, you wrap it in an 'info', 'debug', 'warn', 'error' or 'fatal'.
 //
 // The streams here ensure the data goes where it belongs, without too much
-// buffer space being wasted.
+// buffer space being wasted.  The message is formatted into a preallocated
+// LogPool buffer, so logging does not touch the heap unless the message
+// is too long for the buffer or the pool is exhausted.
 //
 // Example:
 //
@@ -55,12 +64,16 @@ public:
     LogStream(Channel& channel, MsgLevel level, const char* name);
     LogStream(MsgLevel level, const char* name);
     size_t write(uint8_t c) override;
+    size_t write(const uint8_t* buffer, size_t length) override;
     ~LogStream();
 
 private:
     Channel&     _channel;
-    std::string* _line;
+    LogBuffer*   _buf  = nullptr;
+    std::string* _line = nullptr;
     MsgLevel     _level;
+
+    void spill();
 };
 
 extern bool atMsgLevel(MsgLevel level);
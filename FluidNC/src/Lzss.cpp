@@ -0,0 +1,164 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "Lzss.h"
+
+#include <algorithm>
+#include <cstring>
+
+LzssEncoder::LzssEncoder(Sink sink) : _sink(std::move(sink)), _buf(2 * window), _head(hash_size, -1), _prev(2 * window, -1) {}
+
+// Drops the oldest half of the buffer, which is no longer in the window
+void LzssEncoder::slide() {
+    memmove(_buf.data(), _buf.data() + window, window);
+    _len -= window;
+    _pos -= window;
+    auto shift = [](int16_t& p) { p = p < int16_t(window) ? -1 : p - int16_t(window); };
+    for (auto& p : _head) {
+        shift(p);
+    }
+    for (size_t i = 0; i < window; i++) {
+        _prev[i] = _prev[i + window];
+        shift(_prev[i]);
+    }
+}
+
+void LzssEncoder::insert(size_t pos) {
+    if (pos + min_match <= _len) {
+        auto h     = hash(&_buf[pos]);
+        _prev[pos] = _head[h];
+        _head[h]   = int16_t(pos);
+    }
+}
+
+void LzssEncoder::write(const uint8_t* data, size_t length) {
+    while (length) {
+        if (_len == _buf.size()) {
+            slide();
+        }
+        size_t n = std::min(length, _buf.size() - _len);
+        memcpy(&_buf[_len], data, n);
+        _len += n;
+        data += n;
+        length -= n;
+        encode(false);
+    }
+}
+
+void LzssEncoder::finish() {
+    encode(true);
+    if (_items) {
+        _sink(_group, _group_len);
+        _items = 0;
+    }
+}
+
+// Starts a new item in the group, sending the group when it is full
+void LzssEncoder::item(bool literal) {
+    if (_items == 8) {
+        _sink(_group, _group_len);
+        _items = 0;
+    }
+    if (_items == 0) {
+        _group[0]  = 0;
+        _group_len = 1;
+    }
+    if (literal) {
+        _group[0] |= 1 << _items;
+    }
+    ++_items;
+}
+
+// Encodes the buffered data.  Until the end of the data, a position is
+// encoded only when the longest possible match starting there is buffered.
+void LzssEncoder::encode(bool final) {
+    while (_pos < _len && (final || _pos + max_match <= _len)) {
+        size_t best_len  = 0;
+        size_t best_dist = 0;
+        size_t limit     = std::min(max_match, _len - _pos);
+        if (limit >= min_match) {
+            int chain = max_chain;
+            for (int cand = _head[hash(&_buf[_pos])]; cand >= 0 && chain--; cand = _prev[cand]) {
+                size_t dist = _pos - cand;
+                if (dist > window) {
+                    break;
+                }
+                size_t len = 0;
+                while (len < limit && _buf[cand + len] == _buf[_pos + len]) {
+                    ++len;
+                }
+                if (len > best_len) {
+                    best_len  = len;
+                    best_dist = dist;
+                    if (len == limit) {
+                        break;
+                    }
+                }
+            }
+        }
+        if (best_len >= min_match) {
+            item(false);
+            size_t code          = best_dist - 1;
+            _group[_group_len++] = uint8_t(code);
+            _group[_group_len++] = uint8_t(((code >> 8) << 4) | (best_len - min_match));
+        } else {
+            item(true);
+            _group[_group_len++] = _buf[_pos];
+            best_len             = 1;
+        }
+        for (size_t end = _pos + best_len; _pos < end; ++_pos) {
+            insert(_pos);
+        }
+    }
+}
+
+LzssDecoder::LzssDecoder(Sink sink) : _sink(std::move(sink)), _window(window), _out(out_size) {}
+
+void LzssDecoder::put(uint8_t c) {
+    _window[_total++ % window] = c;
+    _out[_out_len++]           = c;
+    if (_out_len == out_size) {
+        _sink(_out.data(), _out_len);
+        _out_len = 0;
+    }
+}
+
+bool LzssDecoder::write(const uint8_t* data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = data[i];
+        if (_flags <= 1) {
+            // The marker bit tells when the flags are used up
+            _flags = c | 0x100;
+            continue;
+        }
+        if (_flags & 1) {
+            put(c);
+            _flags >>= 1;
+            continue;
+        }
+        if (!_have_low) {
+            _low      = c;
+            _have_low = true;
+            continue;
+        }
+        _have_low   = false;
+        size_t dist = ((size_t(c >> 4) << 8) | _low) + 1;
+        size_t len  = (c & 0xf) + 3;
+        if (dist > _total) {
+            return false;
+        }
+        for (size_t from = _total - dist; len--; ++from) {
+            put(_window[from % window]);
+        }
+        _flags >>= 1;
+    }
+    return true;
+}
+
+bool LzssDecoder::finish() {
+    if (_out_len) {
+        _sink(_out.data(), _out_len);
+        _out_len = 0;
+    }
+    return !_have_low;
+}
@@ -0,0 +1,96 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// LZSS compression with a 4 KiB window, for data that is streamed through
+// the controller.  deflate needs far more RAM for its compressor state than
+// the ESP32 can spare, while this encoder needs about 32 KiB and the decoder
+// 4 KiB.  Text like a config file typically shrinks to less than half.
+//
+// The compressed data is a sequence of groups.  Each group starts with a
+// flag byte whose bits, least significant first, describe up to 8 items.
+// A 1 bit is a literal byte.  A 0 bit is a match of two bytes: the low 8
+// bits of the distance minus 1, then the high 4 bits of the distance minus 1
+// and the length minus 3 in the low 4 bits.  The data simply ends after the
+// last item.
+//
+// Neither class depends on the rest of the firmware, so they can be tested
+// on the host.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+class LzssEncoder {
+public:
+    using Sink = std::function<void(const uint8_t* data, size_t length)>;
+
+    explicit LzssEncoder(Sink sink);
+
+    void write(const uint8_t* data, size_t length);
+
+    // Encodes the data that is still buffered.  Call it once, at the end.
+    void finish();
+
+private:
+    static constexpr size_t window    = 4096;
+    static constexpr size_t min_match = 3;
+    static constexpr size_t max_match = 18;
+    static constexpr size_t hash_size = 4096;
+    static constexpr int    max_chain = 64;  // Candidates tried for each match
+
+    Sink _sink;
+
+    // The buffer holds the window before _pos and the data still to be encoded
+    std::vector<uint8_t> _buf;
+    std::vector<int16_t> _head;  // Newest position with each hash, or -1
+    std::vector<int16_t> _prev;  // Older position with the same hash, or -1
+    size_t               _len = 0;
+    size_t               _pos = 0;
+
+    uint8_t _group[1 + 8 * 2];
+    size_t  _group_len = 0;
+    int     _items     = 0;
+
+    static size_t hash(const uint8_t* p) { return ((p[0] << 8) ^ (p[1] << 4) ^ p[2]) & (hash_size - 1); }
+
+    void slide();
+    void insert(size_t pos);
+    void encode(bool final);
+    void item(bool literal);
+};
+
+class LzssDecoder {
+public:
+    using Sink = LzssEncoder::Sink;
+
+    explicit LzssDecoder(Sink sink);
+
+    // Returns false if the data is not valid compressed data
+    bool write(const uint8_t* data, size_t length);
+
+    // Sends the rest of the output.  Returns false if the data ended inside a match.
+    bool finish();
+
+private:
+    static constexpr size_t window   = 4096;
+    static constexpr size_t out_size = 256;
+
+    Sink _sink;
+
+    // On the heap, like the encoder's buffers, so a decoder can be a local
+    // variable in a task with a small stack
+    std::vector<uint8_t> _window;
+    size_t               _total = 0;  // Bytes of output so far
+
+    std::vector<uint8_t> _out;
+    size_t               _out_len = 0;
+
+    unsigned _flags    = 0;  // Item bits still to use, below a marker bit
+    bool     _have_low = false;
+    uint8_t  _low      = 0;
+
+    void put(uint8_t c);
+};
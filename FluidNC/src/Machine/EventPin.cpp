@@ -16,7 +16,6 @@ void InputPin::init() {
 void InputPin::trigger(bool active) {
     update(active);
     log_debug(_legend << " " << active);
-    report_recompute_pin_string();
 }
 
 void EventPin::trigger(bool active) {
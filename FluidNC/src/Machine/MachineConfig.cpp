@@ -15,12 +15,14 @@
 
 #include "src/SettingsDefinitions.h"  // config_filename
 #include "src/FileStream.h"
+#include "src/HashFS.h"
 
 #include "src/Configuration/Parser.h"
 #include "src/Configuration/ParserHandler.h"
 #include "src/Configuration/Validator.h"
 #include "src/Configuration/AfterParse.h"
 #include "src/Configuration/ParseException.h"
+#include "src/Configuration/RuntimeSetting.h"
 #include "src/Config.h"  // ENABLE_*
 
 #include "Driver/restart.h"
@@ -28,7 +30,9 @@
 #include <cstdio>
 #include <cstring>
 #include <atomic>
+#include <map>
 #include <memory>
+#include <vector>
 
 Machine::MachineConfig* config;
 
@@ -177,7 +181,97 @@ namespace Machine {
         }
     }
 
+    // The snapshot of dir/name is the hidden file dir/.name.snap.  It holds
+    // the tokens of the YAML file, as encoded by Tokenizer::encode(), after
+    // a header that ties it to the contents of the file it was made from.
+    struct SnapshotHeader {
+        char     magic[4];
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t source_size;
+        uint32_t length;    // Of the tokens that follow
+        char     hash[68];  // HashFS::hash() of the YAML file, NUL-padded
+    };
+
+    static const char     snapshot_magic[4] = { 'F', 'N', 'C', 'Y' };
+    static const uint16_t snapshot_version  = 1;
+
+    static std::string snapshot_path(const FluidPath& fpath) {
+        return (fpath.parent_path() / ("." + fpath.filename().string() + ".snap")).string();
+    }
+
+    // At boot the local filesystem has not been hashed yet, so the hash is
+    // computed here and cached for HashFS.
+    static std::string config_hash(const FluidPath& fpath) {
+        if (HashFS::file_is_hashable(fpath)) {
+            auto hash = HashFS::hash(fpath, true);
+            if (hash.empty()) {
+                HashFS::rehash_file(fpath, false);
+                hash = HashFS::hash(fpath, true);
+            }
+            return hash;
+        }
+        return HashFS::hash(fpath);
+    }
+
+    static bool read_snapshot(const FluidPath& fpath, SnapshotHeader& header, std::string& tokens) {
+        try {
+            FileStream snapshot(snapshot_path(fpath), "r");
+            if (snapshot.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+                memcmp(header.magic, snapshot_magic, sizeof(header.magic)) || header.version != snapshot_version ||
+                snapshot.size() != sizeof(header) + header.length) {
+                return false;
+            }
+            header.hash[sizeof(header.hash) - 1] = '\0';
+            tokens.resize(header.length);
+            return snapshot.read(tokens.data(), header.length) == header.length;
+        } catch (...) { return false; }
+    }
+
+    // Loads the configuration from the tokens in the snapshot, if the
+    // snapshot was made from the current contents of the YAML file
+    static bool load_snapshot(const FluidPath& fpath, size_t filesize, const std::string& hash) {
+        SnapshotHeader header;
+        std::string    tokens;
+        if (hash.empty() || !read_snapshot(fpath, header, tokens) || header.source_size != filesize) {
+            return false;
+        }
+        if (hash != header.hash) {
+            log_debug("Configuration snapshot is out of date");
+            return false;
+        }
+        MachineConfig::load_yaml(tokens, true);
+        return true;
+    }
+
+    // Saves the tokens of a YAML file that loaded without errors
+    static void save_snapshot(const FluidPath& fpath, size_t filesize, const std::string& hash, std::string_view yaml) {
+        SnapshotHeader header = {};
+        std::string    tokens;
+        if (hash.empty() || hash.length() >= sizeof(header.hash)) {
+            return;
+        }
+        try {
+            if (!Configuration::Tokenizer::encode(yaml, tokens)) {
+                return;
+            }
+            memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+            header.version     = snapshot_version;
+            header.source_size = filesize;
+            header.length      = tokens.length();
+            strcpy(header.hash, hash.c_str());
+
+            FileStream snapshot(snapshot_path(fpath), "w");
+            snapshot.write((uint8_t*)&header, sizeof(header));
+            snapshot.write((uint8_t*)tokens.data(), tokens.length());
+        } catch (...) { log_debug("Cannot write configuration snapshot"); }
+    }
+
+    // The configuration file that the live configuration was loaded from
+    static std::string loaded_file;
+
     void MachineConfig::load_file(const std::string_view filename) {
+        loaded_file.clear();
         try {
             FileStream file(std::string { filename }, "r", "");
 
@@ -187,6 +281,23 @@ namespace Machine {
                 return;
             }
 
+            auto  hash  = config_hash(file.fpath());
+            State state = sys.state;
+            if (load_snapshot(file.fpath(), filesize, hash)) {
+                if (!state_is(State::ConfigAlarm)) {
+                    log_info("Configuration file:" << filename << " from snapshot");
+                    loaded_file = filename;
+                    return;
+                }
+                // The YAML loaded without errors when the snapshot was made,
+                // so the snapshot is at fault.  Parse the YAML instead, which
+                // reports the errors, if any, against its own lines.
+                log_warn("Configuration snapshot of " << filename << " failed, reading the file");
+                std::error_code ec;
+                stdfs::remove(snapshot_path(file.fpath()), ec);
+                set_state(state);
+            }
+
             auto buffer      = std::make_unique<char[]>(filesize + 1);
             buffer[filesize] = '\0';
             auto actual      = file.read(buffer.get(), filesize);
@@ -195,7 +306,12 @@ namespace Machine {
                 return;
             }
             log_info("Configuration file:" << filename);
-            load_yaml(std::string_view { buffer.get(), filesize });
+            std::string_view yaml { buffer.get(), filesize };
+            load_yaml(yaml);
+            if (!state_is(State::ConfigAlarm)) {
+                save_snapshot(file.fpath(), filesize, hash, yaml);
+                loaded_file = filename;
+            }
         } catch (...) {
             log_config_error("Cannot open configuration file:" << filename);
             log_info("Using default configuration");
@@ -204,10 +320,10 @@ namespace Machine {
         }
     }
 
-    void MachineConfig::load_yaml(std::string_view input) {
+    void MachineConfig::load_yaml(std::string_view input, bool snapshot) {
         bool successful = false;
         try {
-            Configuration::Parser        parser(input);
+            Configuration::Parser        parser(input, snapshot);
             Configuration::ParserHandler handler(parser);
 
             // instance() is by reference, so we can just get rid of an old instance and
@@ -257,6 +373,180 @@ namespace Machine {
         std::atomic_thread_fence(std::memory_order::memory_order_seq_cst);
     }
 
+    // Maps the /-separated path of each token to its value
+    static void flatten(std::string_view tokens, std::map<std::string, std::string>& items) {
+        Configuration::Tokenizer                 tokenizer(tokens, true);
+        std::vector<std::pair<int, std::string>> sections;  // Indent and path of the enclosing tokens
+        for (tokenizer.Tokenize(); tokenizer._token._state != Configuration::TokenState::Eof; tokenizer.Tokenize()) {
+            auto& token = tokenizer._token;
+            while (!sections.empty() && sections.back().first >= token._indent) {
+                sections.pop_back();
+            }
+            std::string path = sections.empty() ? "" : sections.back().second + '/';
+            path += token._key;
+            items[path] = token._value;
+            sections.emplace_back(token._indent, path);
+        }
+    }
+
+    // Values that are used only when the hardware they describe is set up,
+    // so a new value takes effect after a restart.  Everything in the
+    // sections is of that kind, as are the items with these names wherever
+    // they are.  Pins are already refused by RuntimeSetting.  A spindle
+    // works out the offsets and scales of its speed_map in init().
+    static const char* const init_only_sections[] = {
+        "uart1", "uart2", "uart_channel1", "uart_channel2", "i2c0", "i2c1", "i2so", "spi", "sdcard",
+    };
+    static const char* const init_only_items[] = {
+        "run_amps", "hold_amps", "microsteps", "r_sense_ohms", "run_mode", "stallguard", "toff_disable", "toff_stealthchop",
+        "toff_coolstep", "tpfd", "pwm_hz", "frequency", "frequency_hz", "baud", "mode", "uart_num", "spi_index", "i2c_num",
+        "i2c_address", "addr", "modbus_id", "planner_blocks", "segments", "engine", "speed_map",
+    };
+
+    static bool init_only(const std::string& path) {
+        std::string_view section(path);
+        section = section.substr(0, section.find('/'));
+        for (auto name : init_only_sections) {
+            if (string_util::equal_ignore_case(section, name)) {
+                return true;
+            }
+        }
+        std::string_view item(path);
+        auto             slash = item.rfind('/');
+        if (slash != std::string_view::npos) {
+            item.remove_prefix(slash + 1);
+        }
+        for (auto name : init_only_items) {
+            if (string_util::equal_ignore_case(item, name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Sets one item as $/path=value does.  Returns false if the item
+    // cannot be changed without a restart.
+    static bool set_item(const std::string& path, const std::string& value, Channel& out) {
+        Configuration::RuntimeSetting rts(path.c_str(), value.c_str(), out);
+        config->group(rts);
+        return rts.isHandled_ && !rts.needsRestart_;
+    }
+
+    static void check_config() {
+        Configuration::Validator validator;
+        config->validate();
+        config->group(validator);
+
+        Configuration::AfterParse afterParseHandler;
+        config->afterParse();
+        config->group(afterParseHandler);
+    }
+
+    Error MachineConfig::reload(Channel& out) {
+        if (loaded_file.empty() || loaded_file != config_filename->get()) {
+            log_error_to(out, "Restart to load " << config_filename->get());
+            return Error::ConfigurationInvalid;
+        }
+
+        // The snapshot of the file that was loaded describes the live
+        // configuration, apart from any $/ changes made since
+        std::string    yaml, old_tokens, new_tokens;
+        SnapshotHeader header;
+        FluidPath      fpath;
+        try {
+            FileStream file(loaded_file, "r", "");
+            fpath = file.fpath();
+            yaml.resize(file.size());
+            if (file.read(yaml.data(), yaml.length()) != yaml.length()) {
+                return Error::FsFailedRead;
+            }
+        } catch (...) { return Error::FsFailedOpenFile; }
+        if (!read_snapshot(fpath, header, old_tokens)) {
+            log_error_to(out, "No snapshot of the loaded configuration");
+            return Error::ConfigurationInvalid;
+        }
+        try {
+            if (!Configuration::Tokenizer::encode(yaml, new_tokens)) {
+                return Error::ConfigurationInvalid;
+            }
+        } catch (const Configuration::ParseException& ex) {
+            log_error_to(out, "Configuration parse error on line " << ex.LineNumber() << ": " << ex.What());
+            return Error::ConfigurationInvalid;
+        }
+
+        std::map<std::string, std::string> old_items, new_items;
+        flatten(old_tokens, old_items);
+        flatten(new_tokens, new_items);
+
+        // Adding or removing items changes the structure of the tree, and
+        // the default values of removed items are not known here
+        bool restart = false;
+        for (const auto& [path, value] : old_items) {
+            if (!new_items.count(path)) {
+                log_info_to(out, "Removed /" << path);
+                restart = true;
+            }
+        }
+        for (const auto& [path, value] : new_items) {
+            if (!old_items.count(path)) {
+                log_info_to(out, "Added /" << path);
+                restart = true;
+            }
+        }
+        if (restart) {
+            log_info_to(out, "Restart to apply the configuration");
+            return Error::Ok;
+        }
+
+        // Changed values are applied as $/path=value would apply them.  If
+        // the result does not validate, the old values are put back.
+        std::vector<std::string> applied;
+        bool                     failed = false;
+        try {
+            for (const auto& [path, value] : new_items) {
+                const auto& old_value = old_items[path];
+                if (value == old_value) {
+                    continue;
+                }
+                if (init_only(path) || !set_item(path, value, out)) {
+                    log_info_to(out, "Restart to change /" << path);
+                    restart = true;
+                    continue;
+                }
+                applied.push_back(path);
+            }
+            if (!applied.empty()) {
+                check_config();
+            }
+        } catch (const AssertionFailed& ex) {
+            log_error_to(out, "Configuration change failed: " << ex.what());
+            failed = true;
+        } catch (std::exception& ex) {
+            log_error_to(out, "Validation error: " << ex.what());
+            failed = true;
+        }
+        if (failed) {
+            try {
+                for (const auto& path : applied) {
+                    set_item(path, old_items[path], out);
+                }
+                check_config();
+                log_info_to(out, "The configuration is unchanged");
+            } catch (...) { log_error_to(out, "Restart to restore the configuration"); }
+            return Error::ConfigurationInvalid;
+        }
+
+        for (const auto& path : applied) {
+            log_info_to(out, "/" << path << ": " << old_items[path] << " -> " << new_items[path]);
+        }
+        if (!restart) {
+            // The file now describes the live configuration
+            save_snapshot(fpath, yaml.length(), config_hash(fpath), yaml);
+        }
+        log_info_to(out, applied.size() << " configuration changes applied");
+        return Error::Ok;
+    }
+
     MachineConfig::~MachineConfig() {
         delete _axes;
         delete _i2so;
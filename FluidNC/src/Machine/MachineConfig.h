@@ -110,7 +110,14 @@ namespace Machine {
 
         static void load();
         static void load_file(std::string_view file);
-        static void load_yaml(std::string_view yaml_string);
+        static void load_yaml(std::string_view yaml_string, bool snapshot = false);
+
+        // Applies the values that changed in the configuration file since it
+        // was loaded, without reinitializing.  Changes that need a restart,
+        // like added or removed items, pins and values that drivers read
+        // only at startup, are reported instead.  If the changed values do
+        // not validate, the old ones are put back.
+        static Error reload(Channel& out);
 
         ~MachineConfig();
     };
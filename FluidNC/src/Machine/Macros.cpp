@@ -6,8 +6,13 @@
 #include "src/System.h"                 // sys
 #include "src/Machine/MachineConfig.h"  // config
 #include "src/Job.h"                    // Job::
+#include "src/InputFile.h"              // InputFile::collapse_line()
+#include "src/FileStream.h"             // FileStream
+#include "src/HashFS.h"                 // HashFS::hash()
+#include "src/string_util.h"            // string_util::starts_with_ignore_case()
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 
 void MacroEvent::run(void* arg) const {
     config->_macros->_macro[_num].run(nullptr);
@@ -70,6 +75,21 @@ bool Macro::run(Channel* channel) {
     return false;
 }
 
+void Macro::prefetch() {
+    MacroCache::prefetch(*this);
+}
+
+void Macros::prefetch() {
+    _startup_line0.prefetch();
+    _startup_line1.prefetch();
+    for (auto& macro : _macro) {
+        macro.prefetch();
+    }
+    _after_homing.prefetch();
+    _after_reset.prefetch();
+    _after_unlock.prefetch();
+}
+
 Error MacroChannel::readLine(char* line, int maxlen) {
     int                len       = 0;
     const std::string& gcode     = _macro->_gcode;
@@ -170,3 +190,239 @@ Error MacroChannel::pollLine(char* line) {
 }
 
 MacroChannel::~MacroChannel() {}
+
+std::map<std::string, MacroCache::Entry> MacroCache::_files;
+
+// The commands that run a file, and the file system they default to
+static const struct {
+    const char* prefix;
+    const char* fs;
+} runCommands[] = {
+    { "$SD/Run=", sdName },
+    { "[ESP220]", sdName },
+    { "$LocalFS/Run=", localfsName },
+    { "[ESP700]", localfsName },
+};
+
+// Calls f with the path and file system of each file that the macro runs
+template <typename F>
+static void for_each_run_file(Macro& macro, F f) {
+    std::string_view gcode = macro.get();
+    while (!gcode.empty()) {
+        auto        end  = gcode.find_first_of("&\n");
+        std::string line = std::string(gcode.substr(0, end));
+        gcode.remove_prefix(end == std::string_view::npos ? gcode.length() : end + 1);
+
+        std::string_view command = string_util::trim(line);
+        for (auto const& run : runCommands) {
+            if (string_util::starts_with_ignore_case(command, run.prefix)) {
+                std::string path(command.substr(strlen(run.prefix)));
+                if (path.empty()) {
+                    break;
+                }
+                if (path[0] != '/') {
+                    path = "/" + path;
+                }
+                f(path, run.fs);
+                break;
+            }
+        }
+    }
+}
+
+void MacroCache::prefetch(Macro& macro) {
+    for_each_run_file(macro, [&](const std::string& path, const char* fs) {
+        std::error_code ec;
+        FluidPath       fpath { path, fs, ec };
+        if (ec) {
+            return;
+        }
+        Entry entry;
+        if (load(fpath, entry)) {
+            _files[fpath.string()] = entry;
+            log_debug("Cached " << fpath.c_str() << " for " << macro.name());
+        }
+    });
+}
+
+// Local filesystem digests come from HashFS, which updates them whenever
+// a file is written.  An SD file is taken to be unchanged while the card
+// stays mounted, since writes through the firmware call forget().
+std::string MacroCache::signature(const FluidPath& fpath) {
+    if (HashFS::file_is_hashable(fpath)) {
+        return HashFS::hash(fpath, true);
+    }
+    return "mount " + std::to_string(FluidPath::sd_mounts());
+}
+
+bool MacroCache::load(const FluidPath& fpath, Entry& entry) {
+    entry.signature = signature(fpath);
+    if (entry.signature.empty()) {
+        return false;
+    }
+    try {
+        FileStream file(fpath, "r");
+        if (file.size() > max_file_size) {
+            return false;
+        }
+        std::string text;
+        char        line[Channel::maxLine];
+        int         len = 0;
+        int         c;
+        do {
+            c = file.read();
+            if (c == '\r') {
+                continue;
+            }
+            if (c == '\n' || (c < 0 && len)) {
+                line[len] = '\0';
+                InputFile::collapse_line(line);
+                text += line;
+                text += '\n';
+                len = 0;
+            } else if (c >= 0) {
+                if (len >= Channel::maxLine - 1) {
+                    // Too long, so let InputFile report the error
+                    return false;
+                }
+                line[len++] = c;
+            }
+        } while (c >= 0);
+        entry.text = std::make_shared<const std::string>(std::move(text));
+    } catch (Error err) { return false; }
+    return true;
+}
+
+Channel* MacroCache::open(const char* fs, const char* path) {
+    std::error_code ec;
+    FluidPath       fpath { path, fs, ec };
+    if (ec) {
+        return nullptr;
+    }
+    auto it = _files.find(fpath.string());
+    if (it == _files.end()) {
+        return nullptr;
+    }
+    auto& entry = it->second;
+    if (signature(fpath) != entry.signature) {
+        log_debug(fpath.c_str() << " changed");
+        if (!load(fpath, entry)) {
+            _files.erase(it);
+            return nullptr;
+        }
+    }
+    return new CachedFileChannel(fpath.string(), entry.text);
+}
+
+void MacroCache::forget(const std::filesystem::path& path) {
+    auto name   = path.string();
+    auto prefix = name + '/';
+    for (auto it = _files.begin(); it != _files.end();) {
+        if (it->first == name || it->first.compare(0, prefix.length(), prefix) == 0) {
+            it = _files.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+std::vector<std::string> Macros::files(Channel& out) {
+    std::vector<std::string> paths;
+    auto                     add = [&](Macro& macro) {
+        for_each_run_file(macro, [&](const std::string& path, const char* fs) {
+            std::error_code ec;
+            FluidPath       fpath { path, fs, ec };
+            if (ec) {
+                log_warn_to(out, "Skipping " << path << " from " << macro.name() << ": " << ec.message());
+                return;
+            }
+            if (std::find(paths.begin(), paths.end(), fpath.string()) == paths.end()) {
+                paths.push_back(fpath.string());
+            }
+        });
+    };
+    add(_startup_line0);
+    add(_startup_line1);
+    for (auto& macro : _macro) {
+        add(macro);
+    }
+    add(_after_homing);
+    add(_after_reset);
+    add(_after_unlock);
+    return paths;
+}
+
+CachedFileChannel::CachedFileChannel(const std::string& path, std::shared_ptr<const std::string> text) :
+    Channel(path, false), _text(std::move(text)) {}
+
+// Like InputFile::readLine()
+Error CachedFileChannel::readLine(char* line, int maxlen) {
+    const std::string& text = *_text;
+    if (_position >= text.length()) {
+        return Error::Eof;
+    }
+    auto end = text.find('\n', _position);
+    if (end == std::string::npos) {
+        end = text.length();
+    }
+    size_t len = end - _position;
+    if (len >= size_t(maxlen)) {
+        return Error::LineLengthExceeded;
+    }
+    memcpy(line, text.data() + _position, len);
+    line[len] = '\0';
+    _position = end + 1;
+    ++_line_number;
+    if (len == 0) {
+        ++_blank_lines;
+    }
+    return Error::Ok;
+}
+
+void CachedFileChannel::ack(Error status) {
+    if (status != Error::Ok) {
+        log_error(static_cast<int>(status) << " (" << errorString(status) << ") in " << name() << " at line " << lineNumber());
+        if (status != Error::GcodeUnsupportedCommand) {
+            // Do not stop on unsupported commands because most senders do not stop.
+            // Stop the file job on other errors
+            notifyf("File job error", "Error:%d in %s at line: %d", status, name().c_str(), lineNumber());
+            _pending_error = status;
+        }
+    }
+}
+
+Error CachedFileChannel::pollLine(char* line) {
+    if (!line) {
+        return Error::NoData;
+    }
+    if (_pending_error != Error::Ok) {
+        return _pending_error;
+    }
+    if (_percent) {
+        _percent = false;
+        // As in InputFile, a % line that is not the first non-blank line ends the file
+        if (_line_number != (_blank_lines + 1)) {
+            _ended = true;
+        }
+    }
+    if (_ended) {
+        _progress = "SD: " + name() + ": Sent";
+        return Error::Eof;
+    }
+    switch (auto err = readLine(line, Channel::maxLine)) {
+        case Error::Ok: {
+            float percent_complete = (float)_position * 100.0f / _text->length();
+
+            std::ostringstream s;
+            s << "SD:" << std::fixed << std::setprecision(2) << percent_complete << "," << name();
+            _progress = s.str();
+        }
+            return Error::Ok;
+        case Error::Eof:
+            _progress = "SD: " + name() + ": Sent";
+            return Error::Eof;
+        default:
+            _progress = "";
+            return err;
+    }
+}
@@ -6,8 +6,13 @@
 
 #include "src/Configuration/Configurable.h"
 #include "src/Event.h"
+#include "src/FluidPath.h"
 // #include <algorithm>  // std::replace()
 
+#include <map>
+#include <memory>
+#include <vector>
+
 class MacroEvent : public Event {
     int _num;
 
@@ -51,6 +56,14 @@ namespace Machine {
             handler.item(_after_unlock.name(), _after_unlock);
         }
 
+        // Reads the files that the macros run into the MacroCache
+        void prefetch();
+
+        // The paths of all the files that the macros run, whatever their size
+        // and whether or not they are cached.  Paths on a file system that
+        // cannot be used are reported to out and left out.
+        static std::vector<std::string> files(Channel& out);
+
         ~Macros() {}
     };
 
@@ -79,4 +92,66 @@ namespace Machine {
 
         ~MacroChannel();
     };
+
+    // MacroCache keeps the text of files that macros run - typically an
+    // m6_macro like $SD/Run=/toolchange.nc - in RAM, with the lines already
+    // collapsed as InputFile::preprocess() does.
+    //
+    // On the local filesystem, a change to a file is seen in its HashFS
+    // digest, which costs nothing to look up.  SD files have no digest, and
+    // hashing them would read the whole file on every run.  Instead, the
+    // commands that write, rename or delete files forget the cached copies
+    // through HashFS, and a cached SD file is used only while the card stays
+    // mounted.  The card is mounted only while it is in use, so the cache
+    // helps when a macro runs during an SD job, like a tool change.  Between
+    // jobs, the card could have been changed elsewhere, and the next run
+    // reads the file again.
+    class MacroCache {
+    public:
+        static const size_t max_file_size = 8192;
+
+        // Reads the files that macro runs
+        static void prefetch(Macro& macro);
+
+        // Returns a channel that reads a cached file, or nullptr if the file is not cached
+        static Channel* open(const char* fs, const char* path);
+
+        // Drops the cached copy of a file, or of the files in a directory
+        static void forget(const std::filesystem::path& path);
+
+    private:
+        struct Entry {
+            std::string                        signature;
+            std::shared_ptr<const std::string> text;
+        };
+        static std::map<std::string, Entry> _files;
+
+        static std::string signature(const FluidPath& fpath);
+        static bool        load(const FluidPath& fpath, Entry& entry);
+    };
+
+    // CachedFileChannel reads a file from the MacroCache, behaving like the
+    // InputFile that would otherwise read it.
+    class CachedFileChannel : public Channel {
+    private:
+        std::shared_ptr<const std::string> _text;  // Kept alive if the cache reloads the file
+        size_t                             _position      = 0;
+        size_t                             _blank_lines   = 0;
+        Error                              _pending_error = Error::Ok;
+
+        Error readLine(char* line, int maxlen);
+
+    public:
+        CachedFileChannel(const std::string& path, std::shared_ptr<const std::string> text);
+
+        CachedFileChannel(const CachedFileChannel&)            = delete;
+        CachedFileChannel& operator=(const CachedFileChannel&) = delete;
+
+        // Channel methods
+        size_t write(uint8_t c) override { return 0; }
+        void   ack(Error status) override;
+        Error  pollLine(char* line) override;
+        size_t position() override { return _position; }
+        void   set_position(size_t pos) override { _position = pos; }
+    };
 }
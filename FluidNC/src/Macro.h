@@ -7,6 +7,7 @@ class Macro {
 public:
     std::string        _gcode;
     bool               run(Channel* channel);
+    void               prefetch();  // Reads the files that the macro runs into the MacroCache
     void               set(const char* value) { _gcode = value; }
     void               set(const std::string& value) { _gcode = value; }
     void               set(const std::string_view value) { _gcode = value; }
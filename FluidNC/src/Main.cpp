@@ -26,14 +26,15 @@
 #    include "src/ToolChangers/atc.h"
 
 extern void make_user_commands();
+extern void build_word_indexes();
 
 void setup() {
     disableCore0WDT();
     try {
         timing_init();
-        uartInit();  // Setup serial port
+        StartupLog::init();  // Starts timing the boot stages
 
-        StartupLog::init();
+        uartInit();  // Setup serial port
 
         // Setup input polling loop after loading the configuration,
         // because the polling may depend on the config
@@ -45,6 +46,7 @@ void setup() {
 
         // Load settings from non-volatile storage
         settings_init();  // requires config
+        StartupLog::stage("settings");
 
         log_info("FluidNC " << git_info << " " << git_url);
         log_info("Compiled with ESP32 SDK:" << esp_get_idf_version());
@@ -53,9 +55,12 @@ void setup() {
             log_error("Cannot mount a local filesystem");
         } else {
             log_info("Local filesystem type is " << localfsName);
+            Coordinates::replay_journal();
         }
+        StartupLog::stage("localfs");
 
         config->load();
+        StartupLog::stage("config");
 
         make_user_commands();
 
@@ -73,6 +78,7 @@ void setup() {
                 config->_uart_channels[i]->init();
             }
         }
+        StartupLog::stage("uarts");
 
 #ifdef CONFIG_IDF_TARGET_ESP32S3
         // I2S not (yet) implemented for ESP32-S3
@@ -80,6 +86,7 @@ void setup() {
         if (config->_i2so) {
             config->_i2so->init();
         }
+        StartupLog::stage("i2so");
 #endif
         if (config->_spi) {
             config->_spi->init();
@@ -88,11 +95,13 @@ void setup() {
                 config->_sdCard->init();
             }
         }
+        StartupLog::stage("spi");
         for (size_t i = 0; i < MAX_N_I2C; i++) {
             if (config->_i2c[i]) {
                 config->_i2c[i]->init();
             }
         }
+        StartupLog::stage("i2c");
 
         Stepping::init();  // Configure stepper interrupt timers
 
@@ -101,27 +110,33 @@ void setup() {
         config->_userOutputs->init();
 
         config->_userInputs->init();
+        StartupLog::stage("stepping");
 
         Axes::init();
+        StartupLog::stage("axes");
 
         config->_control->init();
 
         config->_kinematics->init();
 
         limits_init();
+        StartupLog::stage("control");
 
         // Initialize system state.
         for (auto const& module : Modules()) {
             module->init();
+            StartupLog::stage(module->name());
         }
         for (auto const& module : ConfigurableModules()) {
             module->init();
+            StartupLog::stage(module->name());
         }
 
         auto atcs = ATCs::ATCFactory::objects();
         for (auto const& atc : atcs) {
             atc->init();
         }
+        StartupLog::stage("atc");
 
         if (!state_is(State::ConfigAlarm)) {
             auto spindles = Spindles::SpindleFactory::objects();
@@ -130,17 +145,24 @@ void setup() {
             }
             bool stopped_spindle, new_spindle;
             Spindles::Spindle::switchSpindle(0, spindles, spindle, stopped_spindle, new_spindle);
+            StartupLog::stage("spindles");
 
             config->_coolant->init();
             config->_probe->init();
         }
 
+        // Files run by macros are read once here, so running the macros does not wait for the file system
+        config->_macros->prefetch();
+        StartupLog::stage("macros");
+
         make_proxies();
 
     } catch (const AssertionFailed& ex) {
         // This means something is terribly broken:
         log_config_error("Critical error in main_init: " << ex.what());
     }
+    build_word_indexes();
+    StartupLog::finish();
 
     allChannels.ready();
     allChannels.deregistration(&startupLog);
@@ -13,6 +13,7 @@
 #include "Planner.h"         // plan_reset, etc
 #include "Platform.h"        // WEAK_LINK
 #include "Settings.h"        // coords
+#include "Job.h"             // Job::channel
 
 #include <cmath>
 
@@ -27,6 +28,8 @@
 // this is needed if a jogCancel comes along after we have already parsed a jog and it is in-flight.
 static volatile void* mc_pl_data_inflight;  // holds a plan_line_data_t while mc_move_motors has taken ownership of a line motion
 
+JobAnalyzer* mc_analyzer = nullptr;
+
 void mc_init() {
     mc_pl_data_inflight = NULL;
 }
@@ -51,6 +54,9 @@ bool mc_move_motors(float* target, plan_line_data_t* pl_data) {
 
     // If in check gcode mode, prevent motion by blocking planner. Soft limits still work.
     if (state_is(State::CheckMode)) {
+        if (mc_analyzer) {
+            mc_analyzer->move(target, pl_data->feed_rate, pl_data->motion.rapidMotion, pl_data->motion.inverseTime);
+        }
         mc_pl_data_inflight = NULL;
         return submitted_result;  // Bail, if system abort.
     }
@@ -108,7 +114,9 @@ static bool mc_linear_no_check(float* target, plan_line_data_t* pl_data, float*
 }
 bool mc_linear(float* target, plan_line_data_t* pl_data, float* position) {
     if (!pl_data->is_jog && !pl_data->limits_checked) {  // soft limits for jogs have already been dealt with
-        if (config->_kinematics->invalid_line(target)) {
+        if (mc_analyzer) {
+            mc_analyzer->check(target, Job::active() ? Job::channel()->lineNumber() : 0);
+        } else if (config->_kinematics->invalid_line(target)) {
             return false;
         }
     }
@@ -136,7 +144,8 @@ void mc_arc(float*            target,
 
     // The first two axes are the circle plane and the third is the orthogonal plane
     size_t caxes[3] = { axis_0, axis_1, axis_linear };
-    if (config->_kinematics->invalid_arc(target, pl_data, position, center, radius, caxes, is_clockwise_arc)) {
+    // When analyzing, the segments are checked one by one
+    if (!mc_analyzer && config->_kinematics->invalid_arc(target, pl_data, position, center, radius, caxes, is_clockwise_arc)) {
         return;
     }
 
@@ -266,7 +275,13 @@ void mc_arc(float*            target,
 
 // Execute dwell in seconds.
 bool mc_dwell(int32_t milliseconds) {
-    if (milliseconds < 0 || state_is(State::CheckMode)) {
+    if (milliseconds < 0) {
+        return false;
+    }
+    if (state_is(State::CheckMode)) {
+        if (mc_analyzer) {
+            mc_analyzer->dwell(milliseconds / 1000.0f);
+        }
         return false;
     }
     protocol_buffer_synchronize();
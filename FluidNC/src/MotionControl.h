@@ -9,6 +9,7 @@
 #include "Planner.h"
 #include "Config.h"
 #include "Probe.h"
+#include "JobAnalyzer.h"
 
 #include <cstdint>
 
@@ -16,6 +17,10 @@ extern volatile bool probing;  // Probing state value.  Used to coordinate the p
 
 extern bool probe_succeeded;  // Tracks if last probing cycle was successful.
 
+// In check mode, moves and dwells are passed to mc_analyzer when it is set,
+// and soft limit violations are counted instead of raising an alarm.
+extern JobAnalyzer* mc_analyzer;
+
 // System motion commands must have a line number of zero.
 const int PARKING_MOTION_LINE_NUMBER = 0;
 
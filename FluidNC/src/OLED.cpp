@@ -1,6 +1,8 @@
 #include "OLED.h"
 
 #include "Machine/MachineConfig.h"
+#include "Job.h"
+#include "StatusSnapshot.h"
 
 void OLED::show(Layout& layout, const char* msg) {
     if (_width < layout._width_required) {
@@ -89,11 +91,6 @@ void OLED::init() {
     setReportInterval(_report_interval_ms);
 }
 
-Error OLED::pollLine(char* line) {
-    autoReport();
-    return Error::NoData;
-}
-
 void OLED::show_state() {
     show(stateLayout, _state);
 }
@@ -195,200 +192,100 @@ void OLED::show_radio_info() {
     }
 }
 
-void OLED::parse_numbers(std::string s, float* nums, int maxnums) {
-    size_t pos     = 0;
-    size_t nextpos = -1;
-    size_t i       = 0;
-    do {
-        if (i >= maxnums) {
-            return;
-        }
-        nextpos   = s.find_first_of(",", pos);
-        auto num  = s.substr(pos, nextpos - pos);
-        nums[i++] = std::strtof(num.c_str(), nullptr);
-        pos       = nextpos + 1;
-    } while (nextpos != std::string::npos);
-}
+// The display is drawn from the status snapshot rather than by parsing the
+// text of status reports.  Like the radio messages, it is drawn by the
+// output task, so only that task uses the display and the I2C bus, and the
+// polling task does not wait for a frame to be sent.  autoReport() just
+// sends the output task a line that asks for a redraw.
+static const char redraw_line[] = "[OLED redraw]";
 
-void OLED::parse_axes(std::string s, float* axes) {
-    size_t pos     = 0;
-    size_t nextpos = -1;
-    size_t axis    = 0;
-    do {
-        nextpos  = s.find_first_of(",", pos);
-        auto num = s.substr(pos, nextpos - pos);
-        if (axis < MAX_N_AXIS) {
-            axes[axis++] = std::strtof(num.c_str(), nullptr);
-        }
-        pos = nextpos + 1;
-    } while (nextpos != std::string::npos);
+void OLED::autoReport(const StatusValues& values) {
+    if (!_reportInterval || int32_t(xTaskGetTickCount() - _nextReportTime) < 0) {
+        return;
+    }
+    _nextReportTime = xTaskGetTickCount() + _reportInterval;
+
+    // Redraw only if something on the screen would change.  The job hash
+    // changes as the file is read, so it covers the progress display.
+    if (values.state == _shown.state && values.mpos == _shown.mpos && !memcmp(values.pos, _shown.pos, sizeof(values.pos)) &&
+        !strcmp(values.pins, _shown.pins) && values.job_hash == _shown.job_hash) {
+        return;
+    }
+    _shown = values;
+    if (!_redraw.exchange(true)) {
+        sendLine(MsgLevelNone, redraw_line);
+    }
 }
 
-void OLED::parse_status_report() {
-    if (_report.back() == '>') {
-        _report.pop_back();
+// progress is like "SD:12.34,/sd/file.nc"
+void OLED::parse_progress(const std::string& progress) {
+    _filename = "";
+    if (progress.rfind("SD:", 0) != 0) {
+        return;
     }
-    // Now the string is a sequence of field|field|field
-    size_t pos     = 0;
-    auto   nextpos = _report.find_first_of("|", pos);
-    _state         = _report.substr(pos + 1, nextpos - pos - 1);
+    auto commaPos = progress.find_first_of(",");
+    if (commaPos == std::string::npos) {
+        return;
+    }
+    _percent  = std::strtof(progress.c_str() + 3, nullptr);
+    _filename = progress.substr(commaPos + 1);
+}
+
+void OLED::show_status(const StatusValues& values) {
+    _state = values.state;
 
     bool probe              = false;
     bool limits[MAX_N_AXIS] = { false };
+    for (const char* p = values.pins; *p; ++p) {
+        switch (*p) {
+            case 'P':
+                probe = true;
+                break;
+            case 'X':
+                limits[X_AXIS] = true;
+                break;
+            case 'Y':
+                limits[Y_AXIS] = true;
+                break;
+            case 'Z':
+                limits[Z_AXIS] = true;
+                break;
+            case 'A':
+                limits[A_AXIS] = true;
+                break;
+            case 'B':
+                limits[B_AXIS] = true;
+                break;
+            case 'C':
+                limits[C_AXIS] = true;
+                break;
+        }
+    }
 
+    // Show linear axes in the same units as status reports
     float axes[MAX_N_AXIS];
-    bool  isMpos = false;
-    _filename    = "";
-
-    // ... handle it
-    while (nextpos != std::string::npos) {
-        pos        = nextpos + 1;
-        nextpos    = _report.find_first_of("|", pos);
-        auto field = _report.substr(pos, nextpos - pos);
-        // MPos:, WPos:, Bf:, Ln:, FS:, Pn:, WCO:, Ov:, A:, SD: (ISRs:, Heap:)
-        auto colon = field.find_first_of(":");
-        auto tag   = field.substr(0, colon);
-        auto value = field.substr(colon + 1);
-        if (tag == "MPos") {
-            // x,y,z,...
-            parse_axes(value, axes);
-            isMpos = true;
-            continue;
-        }
-        if (tag == "WPos") {
-            // x,y,z...
-            parse_axes(value, axes);
-            isMpos = false;
-            continue;
-        }
-        if (tag == "Bf") {
-            // buf_avail,rx_avail
-            continue;
-        }
-        if (tag == "Ln") {
-            // n
-            auto linenum = std::strtol(value.c_str(), nullptr, 10);
-            continue;
-        }
-        if (tag == "FS") {
-            // feedrate,spindle_speed
-            float fs[2];
-            parse_numbers(value, fs, 2);  // feed in [0], spindle in [1]
-            continue;
-        }
-        if (tag == "Pn") {
-            // PXxYy etc
-            for (char const& c : value) {
-                switch (c) {
-                    case 'P':
-                        probe = true;
-                        break;
-                    case 'X':
-                        limits[X_AXIS] = true;
-                        break;
-                    case 'Y':
-                        limits[Y_AXIS] = true;
-                        break;
-                    case 'Z':
-                        limits[Z_AXIS] = true;
-                        break;
-                    case 'A':
-                        limits[A_AXIS] = true;
-                        break;
-                    case 'B':
-                        limits[B_AXIS] = true;
-                        break;
-                    case 'C':
-                        limits[C_AXIS] = true;
-                        break;
-                }
-                continue;
-            }
-        }
-        if (tag == "WCO") {
-            // x,y,z,...
-            // We do not use the WCO values because the DROs show whichever
-            // position is in the status report
-            // float wcos[MAX_N_AXIS];
-            // auto  wcos = parse_axes(value, wcos);
-            continue;
-        }
-        if (tag == "Ov") {
-            // feed_ovr,rapid_ovr,spindle_ovr
-            float frs[3];
-            parse_numbers(value, frs, 3);  // feed in [0], rapid in [1], spindle in [2]
-            continue;
-        }
-        if (tag == "A") {
-            // SCFM
-            int  spindle = 0;
-            bool flood   = false;
-            bool mist    = false;
-            for (char const& c : value) {
-                switch (c) {
-                    case 'S':
-                        spindle = 1;
-                        break;
-                    case 'C':
-                        spindle = 2;
-                        break;
-                    case 'F':
-                        flood = true;
-                        break;
-                    case 'M':
-                        mist = true;
-                        break;
-                }
-            }
-            continue;
-        }
-        if (tag == "SD") {
-            auto commaPos = value.find_first_of(",");
-            _percent      = std::strtof(value.substr(0, commaPos).c_str(), nullptr);
-            _filename     = value.substr(commaPos + 1);
-            continue;
+    for (size_t axis = 0; axis < MAX_N_AXIS; axis++) {
+        axes[axis] = values.pos[axis];
+        if (config->_reportInches && (axis < A_AXIS || axis > C_AXIS)) {
+            axes[axis] /= MM_PER_INCH;
         }
     }
+
+    if (values.job_hash && Job::active()) {
+        parse_progress(Job::channel()->_progress);
+    } else {
+        _filename = "";
+    }
+
     _oled->clear();
     show_state();
     show_file();
     show_limits(probe, limits);
-    show_dro(axes, isMpos, limits);
+    show_dro(axes, values.mpos, limits);
     show_radio_info();
     _oled->display();
 }
 
-void OLED::parse_gcode_report() {
-    size_t pos     = 0;
-    size_t nextpos = _report.find_first_of(":", pos);
-    auto   name    = _report.substr(pos, nextpos - pos);
-    if (name != "[GC") {
-        return;
-    }
-    pos = nextpos + 1;
-    do {
-        nextpos  = _report.find_first_of(" ", pos);
-        auto tag = _report.substr(pos, nextpos - pos);
-        // G80 G0 G1 G2 G3  G38.2 G38.3 G38.4 G38.5
-        // G54 .. G59
-        // G17 G18 G19
-        // G20 G21
-        // G90 G91
-        // G94 G93
-        // M0 M1 M2 M30
-        // M3 M4 M5
-        // M7 M8 M9
-        // M56
-        // Tn
-        // Fn
-        // Sn
-        //        if (tag == "G0") {
-        //            continue;
-        //        }
-        pos = nextpos + 1;
-    } while (nextpos != std::string::npos);
-}
-
 // [MSG:INFO: Connecting to STA:SSID foo]
 void OLED::parse_STA() {
     size_t start = strlen("[MSG:INFO: Connecting to STA SSID:");
@@ -459,12 +356,11 @@ void OLED::parse_report() {
     if (_report.length() == 0) {
         return;
     }
-    if (_report.rfind("<", 0) == 0) {
-        parse_status_report();
-        return;
-    }
-    if (_report.rfind("[GC:", 0) == 0) {
-        parse_gcode_report();
+    if (_report == redraw_line) {
+        _redraw = false;
+        StatusValues values;
+        StatusSnapshot::read(values);
+        show_status(values);
         return;
     }
     if (_report.rfind("[MSG:INFO: Connecting to STA SSID:", 0) == 0) {
@@ -8,6 +8,8 @@
 #include "src/Module.h"
 #include "SSD1306_I2C.h"
 
+#include <atomic>
+
 typedef const uint8_t* font_t;
 
 class OLED : public Channel, public ConfigurableModule {
@@ -43,23 +45,23 @@ private:
     float       _percent;
     std::string _ticker;
 
+    StatusValues      _shown = {};       // The status values that were last drawn
+    std::atomic<bool> _redraw { false };  // A redraw has been sent to the output task
+
     int _radio_delay        = 0;
     int _report_interval_ms = 500;
 
     uint8_t _i2c_num = 0;
 
     void parse_report();
-    void parse_status_report();
-    void parse_gcode_report();
+    void show_status(const StatusValues& values);
+    void parse_progress(const std::string& progress);
     void parse_STA();
     void parse_IP();
     void parse_AP();
     void parse_BT();
     void parse_WebUI();
 
-    void parse_axes(std::string s, float* axes);
-    void parse_numbers(std::string s, float* nums, int maxnums);
-
     void show_limits(bool probe, const bool* limits);
     void show_state();
     void show_file();
@@ -106,7 +108,9 @@ public:
     int read(void) override { return -1; }
     int peek(void) override { return -1; }
 
-    Error pollLine(char* line) override;
+    Error pollLine(char* line) override { return Error::NoData; }
+    bool  statusReportDue(const StatusValues& values, int32_t now) override { return false; }
+    void  autoReport(const StatusValues& values) override;
     void  flushRx() override {}
 
     bool   lineComplete(char*, char) override { return false; }
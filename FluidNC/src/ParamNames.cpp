@@ -0,0 +1,206 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "ParamNames.h"
+
+#include <cctype>
+
+std::vector<ParamNames::Entry> ParamNames::_names;
+std::vector<param_name_t>      ParamNames::_slots;
+
+// FNV-1a, ignoring case so system parameter names can be matched
+static constexpr uint32_t name_hash(std::string_view name) {
+    uint32_t hash = 2166136261u;
+    for (char c : name) {
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ uint8_t(c)) * 16777619u;
+    }
+    return hash;
+}
+
+static bool equal_lower(std::string_view name, std::string_view lower) {
+    if (name.length() != lower.length()) {
+        return false;
+    }
+    for (size_t i = 0; i < name.length(); ++i) {
+        if (tolower(name[i]) != lower[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// A switch on the hash is a perfect hash of the system parameter names -
+// the compiler rejects duplicate case labels, so no two of them collide.
+// The name is then compared, once, to reject other names with the same hash.
+static SysParam classify(std::string_view name, uint32_t hash, int8_t& axis) {
+    SysParam    sys   = SysParam::None;
+    const char* match = "";
+    axis              = -1;
+
+#define SYS(str, value)                                                                                                                    \
+    case name_hash(str):                                                                                                                   \
+        sys   = value;                                                                                                                     \
+        match = str;                                                                                                                       \
+        break;
+#define AXIS(str, value, n)                                                                                                                \
+    case name_hash(str):                                                                                                                   \
+        sys   = value;                                                                                                                     \
+        match = str;                                                                                                                       \
+        axis  = n;                                                                                                                         \
+        break;
+
+    switch (hash) {
+        AXIS("_x", SysParam::WorkPosition, 0)
+        AXIS("_y", SysParam::WorkPosition, 1)
+        AXIS("_z", SysParam::WorkPosition, 2)
+        AXIS("_a", SysParam::WorkPosition, 3)
+        AXIS("_b", SysParam::WorkPosition, 4)
+        AXIS("_c", SysParam::WorkPosition, 5)
+        AXIS("_abs_x", SysParam::MachinePosition, 0)
+        AXIS("_abs_y", SysParam::MachinePosition, 1)
+        AXIS("_abs_z", SysParam::MachinePosition, 2)
+        AXIS("_abs_a", SysParam::MachinePosition, 3)
+        AXIS("_abs_b", SysParam::MachinePosition, 4)
+        AXIS("_abs_c", SysParam::MachinePosition, 5)
+        SYS("_spindle_rpm_mode", SysParam::Unsupported)
+        SYS("_spindle_css_mode", SysParam::Unsupported)
+        SYS("_ijk_absolute_mode", SysParam::Unsupported)
+        SYS("_lathe_diameter_mode", SysParam::Unsupported)
+        SYS("_lathe_radius_mode", SysParam::Unsupported)
+        SYS("_adaptive_feed", SysParam::Unsupported)
+        SYS("_spindle_on", SysParam::SpindleOn)
+        SYS("_spindle_cw", SysParam::SpindleCw)
+        SYS("_spindle_m", SysParam::SpindleM)
+        SYS("_mist", SysParam::Mist)
+        SYS("_flood", SysParam::Flood)
+        SYS("_speed_override", SysParam::SpeedOverride)
+        SYS("_feed_override", SysParam::FeedOverride)
+        SYS("_feed_hold", SysParam::FeedHold)
+        SYS("_feed", SysParam::Feed)
+        SYS("_rpm", SysParam::Rpm)
+        SYS("_selected_tool", SysParam::SelectedTool)
+        SYS("_current_tool", SysParam::CurrentTool)
+        SYS("_vmajor", SysParam::VMajor)
+        SYS("_vminor", SysParam::VMinor)
+        SYS("_line", SysParam::Line)
+        SYS("_motion_mode", SysParam::MotionMode)
+        SYS("_plane", SysParam::Plane)
+        SYS("_coord_system", SysParam::CoordSystem)
+        SYS("_metric", SysParam::Metric)
+        SYS("_imperial", SysParam::Imperial)
+        SYS("_absolute", SysParam::Absolute)
+        SYS("_incremental", SysParam::Incremental)
+        SYS("_inverse_time", SysParam::InverseTime)
+        SYS("_units_per_minute", SysParam::UnitsPerMinute)
+        SYS("_units_per_rev", SysParam::UnitsPerRev)
+        default:
+            break;
+    }
+#undef SYS
+#undef AXIS
+
+    if (sys != SysParam::None && !equal_lower(name, match)) {
+        axis = -1;
+        return SysParam::None;
+    }
+    return sys;
+}
+
+param_name_t ParamNames::intern(std::string_view name) {
+    uint32_t hash = name_hash(name);
+    if (!_slots.empty()) {
+        size_t mask = _slots.size() - 1;
+        for (size_t i = hash & mask; _slots[i] != no_param_name; i = (i + 1) & mask) {
+            auto& entry = _names[_slots[i]];
+            if (entry.hash == hash && entry.name == name) {
+                return _slots[i];
+            }
+        }
+    }
+
+    // Keep the table at most half full
+    if ((_names.size() + 1) * 2 > _slots.size()) {
+        grow();
+    }
+    param_name_t handle = _names.size();
+    int8_t       axis;
+    SysParam     sys = classify(name, hash, axis);
+    _names.push_back({ std::string(name), hash, sys, axis });
+
+    size_t mask = _slots.size() - 1;
+    size_t i    = hash & mask;
+    while (_slots[i] != no_param_name) {
+        i = (i + 1) & mask;
+    }
+    _slots[i] = handle;
+    return handle;
+}
+
+void ParamNames::grow() {
+    size_t size = _slots.empty() ? 64 : _slots.size() * 2;
+    _slots.assign(size, no_param_name);
+    size_t mask = size - 1;
+    for (param_name_t handle = 0; handle < param_name_t(_names.size()); ++handle) {
+        size_t i = _names[handle].hash & mask;
+        while (_slots[i] != no_param_name) {
+            i = (i + 1) & mask;
+        }
+        _slots[i] = handle;
+    }
+}
+
+// Handles are small consecutive integers, so multiplicative hashing
+// spreads them well.
+static inline size_t slot_of(param_name_t key, size_t mask) {
+    return (uint32_t(key) * 2654435761u) & mask;
+}
+
+size_t ParamValues::find(param_name_t key) const {
+    size_t mask = _slots.size() - 1;
+    size_t i    = slot_of(key, mask);
+    while (_slots[i].key != key && _slots[i].key != no_param_name) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+bool ParamValues::get(param_name_t key, float& value) const {
+    if (_slots.empty()) {
+        return false;
+    }
+    auto& slot = _slots[find(key)];
+    if (slot.key != key) {
+        return false;
+    }
+    value = slot.value;
+    return true;
+}
+
+bool ParamValues::exists(param_name_t key) const {
+    return !_slots.empty() && _slots[find(key)].key == key;
+}
+
+void ParamValues::set(param_name_t key, float value) {
+    if ((_count + 1) * 2 > _slots.size()) {
+        grow();
+    }
+    auto& slot = _slots[find(key)];
+    if (slot.key != key) {
+        slot.key = key;
+        ++_count;
+    }
+    slot.value = value;
+}
+
+void ParamValues::grow() {
+    std::vector<Slot> old(_slots.empty() ? 16 : _slots.size() * 2, Slot { no_param_name, 0.0f });
+    old.swap(_slots);
+    for (auto& slot : old) {
+        if (slot.key != no_param_name) {
+            _slots[find(slot.key)] = slot;
+        }
+    }
+}
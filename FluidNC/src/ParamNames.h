@@ -0,0 +1,99 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Named parameter names are interned: the first time a name is parsed it
+// is entered into a hash table, and every later reference to it uses the
+// index of that entry - its handle - instead of the string.  The entry also
+// records, once, whether the name is a system parameter like _x or _rpm and
+// which one, so evaluating a reference does no string work at all.
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+typedef int32_t param_name_t;
+
+const param_name_t no_param_name = -1;
+
+// Read-only system parameters.  The names are matched without regard to case.
+enum class SysParam : uint8_t {
+    None,
+    WorkPosition,     // _x, _y, _z, _a, _b, _c
+    MachinePosition,  // _abs_x ... _abs_c
+    Unsupported,      // Always 0
+    SpindleOn,
+    SpindleCw,
+    SpindleM,
+    Mist,
+    Flood,
+    SpeedOverride,
+    FeedOverride,
+    FeedHold,
+    Feed,
+    Rpm,
+    SelectedTool,
+    CurrentTool,
+    VMajor,
+    VMinor,
+    Line,
+    MotionMode,
+    Plane,
+    CoordSystem,
+    Metric,
+    Imperial,
+    Absolute,
+    Incremental,
+    InverseTime,
+    UnitsPerMinute,
+    UnitsPerRev,
+};
+
+class ParamNames {
+public:
+    // intern() returns the handle for name, entering it if it is new.
+    // Parameter names are upper case by the time they are interned.
+    static param_name_t intern(std::string_view name);
+
+    static const std::string& name(param_name_t handle) { return _names[handle].name; }
+
+    // For WorkPosition and MachinePosition, axis is the axis number
+    static SysParam system_param(param_name_t handle, int& axis) {
+        axis = _names[handle].axis;
+        return _names[handle].sys;
+    }
+
+private:
+    struct Entry {
+        std::string name;
+        uint32_t    hash;
+        SysParam    sys;
+        int8_t      axis;
+    };
+
+    static std::vector<Entry>        _names;
+    static std::vector<param_name_t> _slots;  // Open addressing, power of 2 size
+
+    static void grow();
+};
+
+// A flat open-addressing map from name handles to values, used for the
+// global named parameters and for the local ones of each job.
+class ParamValues {
+    struct Slot {
+        param_name_t key;
+        float        value;
+    };
+    std::vector<Slot> _slots;  // Power of 2 size
+    size_t            _count = 0;
+
+    size_t find(param_name_t key) const;
+    void   grow();
+
+public:
+    bool get(param_name_t key, float& value) const;
+    void set(param_name_t key, float value);
+    bool exists(param_name_t key) const;
+};
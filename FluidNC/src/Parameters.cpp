@@ -11,6 +11,7 @@
 #include "MotionControl.h"
 #include "GCode.h"
 #include "Job.h"
+#include "ParamNames.h"
 
 #include <string>
 #include <map>
@@ -48,8 +49,8 @@ static bool can_read_float_param(ngc_param_id_t id) {
         // M66
         return true;
     }
-    if (id >= 31 && id <= 5000) {
-        // User parameters
+    if (id >= 1 && id <= 5000) {
+        // Subroutine arguments and user parameters
         return true;
     }
     return false;
@@ -71,41 +72,9 @@ const std::map<const ngc_param_id_t, CoordIndex> axis_params = {
     // { 5401, CoordIndex::TLO },
 };
 
-const std::map<const std::string, int> work_positions = {
-    { "_x", 0 },
-    { "_y", 1 },
-    { "_z", 2 },
-    { "_a", 3 },
-    { "_b", 4 },
-    { "_c", 5 },
-    //    { "_u", 0},
-    //    { "_v", 0},
-    //    { "_w", 0},
-};
-const std::map<const std::string, int> machine_positions = {
-    { "_abs_x", 0 },
-    { "_abs_y", 1 },
-    { "_abs_z", 2 },
-    { "_abs_a", 3 },
-    { "_abs_b", 4 },
-    { "_abs_c", 5 },
-    //    { "_abs_u", 0},
-    //    { "_abs_v", 0},
-    //    { "_abs_w", 0},
-};
-
-const std::array<const std::string, 6> unsupported_sys = {
-    "_spindle_rpm_mode",
-    "_spindle_css_mode",
-    "_ijk_absolute_mode",
-    "_lathe_diameter_mode",
-    "_lathe_radius_mode",
-    "_adaptive_feed",
-};
-
 // clang-format on
 
-std::map<std::string, float> global_named_params;
+ParamValues global_named_params;
 
 bool ngc_param_is_rw(ngc_param_id_t id) {
     return true;
@@ -193,11 +162,8 @@ bool get_numbered_param(ngc_param_id_t id, float& result) {
     return false;
 }
 
-// TODO - make this a variant?
-struct param_ref_t {
-    std::string    name;  // If non-empty, the parameter is named
-    ngc_param_id_t id;    // Valid if name is empty
-};
+static const size_t maxParamName = 128;
+
 std::vector<std::tuple<param_ref_t, float>> assignments;
 
 bool set_config_item(const std::string& name, float result) {
@@ -231,148 +197,110 @@ bool get_config_item(const std::string& name, float& result) {
 
 int coord_values[] = { 540, 550, 560, 570, 580, 590, 591, 592, 593 };
 
-bool get_system_param(const std::string& name, float& result) {
-    std::string sysn;
-    for (auto const& c : name) {
-        sysn += tolower(c);
-    }
-    if (auto search = work_positions.find(sysn); search != work_positions.end()) {
-        auto axis = search->second;
-        result    = to_inches(axis, get_mpos()[axis] - get_wco()[axis]);
-        return true;
-    }
-    if (auto search = machine_positions.find(sysn); search != machine_positions.end()) {
-        auto axis = search->second;
-        result    = to_inches(axis, get_mpos()[axis]);
-        return true;
-    }
-    if (std::find(unsupported_sys.begin(), unsupported_sys.end(), sysn) != unsupported_sys.end()) {
-        result = 0.0;
-        return true;
-    }
-    if (sysn == "_spindle_on") {
-        result = gc_state.modal.spindle != SpindleState::Disable;
-        return true;
-    }
-    if (sysn == "_spindle_cw") {
-        result = gc_state.modal.spindle == SpindleState::Cw;
-        return true;
-    }
-    if (sysn == "_spindle_m") {
-        result = static_cast<int>(gc_state.modal.spindle);
-        return true;
-    }
-
-    if (sysn == "_mist") {
-        result = gc_state.modal.coolant.Mist;
-        return true;
-    }
-    if (sysn == "_flood") {
-        result = gc_state.modal.coolant.Flood;
-        return true;
-    }
-    if (sysn == "_speed_override") {
-        result = sys.spindle_speed_ovr != 100;
-        return true;
-    }
-    if (sysn == "_feed_override") {
-        result = sys.f_override != 100;
-        return true;
-    }
-    if (sysn == "_feed_hold") {
-        result = sys.state == State::Hold;
-        return true;
-    }
-    if (sysn == "_feed") {
-        result = to_inches(0, gc_state.feed_rate);
-        return true;
-    }
-    if (sysn == "_rpm") {
-        result = gc_state.spindle_speed;
-        return true;
-    }
-    if (sysn == "_selected_tool") {
-        result = gc_state.selected_tool;
-        return true;
-    }
-
-    if (sysn == "_current_tool") {
-        result = gc_state.current_tool;
-        return true;
-    }
-
-    if (sysn == "_vmajor") {
-        std::string version(grbl_version);
-        auto        major = version.substr(0, version.find('.'));
-        result            = atoi(major.c_str());
-        return true;
-    }
-    if (sysn == "_vminor") {
-        std::string version(grbl_version);
-        auto        minor = version.substr(version.find('.') + 1);
-
-        result = atoi(minor.c_str());
-        return true;
-    }
-    if (sysn == "_line") {
-        //XXX Implement me
-        return true;
-    }
-    if (sysn == "_motion_mode") {
-        result = static_cast<gcodenum_t>(gc_state.modal.motion);
-        return true;
-    }
-    if (sysn == "_plane") {
-        result = static_cast<gcodenum_t>(gc_state.modal.plane_select);
-        return true;
-    }
-#if 0
-    if (sysn == "_ccomp") {
-        result = static_cast<gcodenum_t>(gc_state.modal.cutter_comp);
-        return true;
-    }
-#endif
-    if (sysn == "_coord_system") {
-        result = coord_values[gc_state.modal.coord_select];
-        return true;
-    }
+static bool get_system_param(param_name_t name, float& result) {
+    int axis;
+    switch (ParamNames::system_param(name, axis)) {
+        case SysParam::None:
+            return false;
+        case SysParam::WorkPosition:
+            result = to_inches(axis, get_mpos()[axis] - get_wco()[axis]);
+            return true;
+        case SysParam::MachinePosition:
+            result = to_inches(axis, get_mpos()[axis]);
+            return true;
+        case SysParam::Unsupported:
+            result = 0.0;
+            return true;
+        case SysParam::SpindleOn:
+            result = gc_state.modal.spindle != SpindleState::Disable;
+            return true;
+        case SysParam::SpindleCw:
+            result = gc_state.modal.spindle == SpindleState::Cw;
+            return true;
+        case SysParam::SpindleM:
+            result = static_cast<int>(gc_state.modal.spindle);
+            return true;
+        case SysParam::Mist:
+            result = gc_state.modal.coolant.Mist;
+            return true;
+        case SysParam::Flood:
+            result = gc_state.modal.coolant.Flood;
+            return true;
+        case SysParam::SpeedOverride:
+            result = sys.spindle_speed_ovr != 100;
+            return true;
+        case SysParam::FeedOverride:
+            result = sys.f_override != 100;
+            return true;
+        case SysParam::FeedHold:
+            result = sys.state == State::Hold;
+            return true;
+        case SysParam::Feed:
+            result = to_inches(0, gc_state.feed_rate);
+            return true;
+        case SysParam::Rpm:
+            result = gc_state.spindle_speed;
+            return true;
+        case SysParam::SelectedTool:
+            result = gc_state.selected_tool;
+            return true;
+        case SysParam::CurrentTool:
+            result = gc_state.current_tool;
+            return true;
+        case SysParam::VMajor: {
+            std::string version(grbl_version);
+            auto        major = version.substr(0, version.find('.'));
+            result            = atoi(major.c_str());
+            return true;
+        }
+        case SysParam::VMinor: {
+            std::string version(grbl_version);
+            auto        minor = version.substr(version.find('.') + 1);
 
-    if (sysn == "_metric") {
-        result = gc_state.modal.units == Units::Mm;
-        return true;
-    }
-    if (sysn == "_imperial") {
-        result = gc_state.modal.units == Units::Inches;
-        return true;
-    }
-    if (sysn == "_absolute") {
-        result = gc_state.modal.distance == Distance::Absolute;
-        return true;
-    }
-    if (sysn == "_incremental") {
-        result = gc_state.modal.distance == Distance::Incremental;
-        return true;
-    }
-    if (sysn == "_inverse_time") {
-        result = gc_state.modal.feed_rate == FeedRate::InverseTime;
-        return true;
-    }
-    if (sysn == "_units_per_minute") {
-        result = gc_state.modal.feed_rate == FeedRate::UnitsPerMin;
-        return true;
-    }
-    if (sysn == "_units_per_rev") {
-        // result = gc_state.modal.feed_rate == FeedRate::UnitsPerRev;
-        result = 0.0;
-        return true;
+            result = atoi(minor.c_str());
+            return true;
+        }
+        case SysParam::Line:
+            //XXX Implement me
+            return true;
+        case SysParam::MotionMode:
+            result = static_cast<gcodenum_t>(gc_state.modal.motion);
+            return true;
+        case SysParam::Plane:
+            result = static_cast<gcodenum_t>(gc_state.modal.plane_select);
+            return true;
+        case SysParam::CoordSystem:
+            result = coord_values[gc_state.modal.coord_select];
+            return true;
+        case SysParam::Metric:
+            result = gc_state.modal.units == Units::Mm;
+            return true;
+        case SysParam::Imperial:
+            result = gc_state.modal.units == Units::Inches;
+            return true;
+        case SysParam::Absolute:
+            result = gc_state.modal.distance == Distance::Absolute;
+            return true;
+        case SysParam::Incremental:
+            result = gc_state.modal.distance == Distance::Incremental;
+            return true;
+        case SysParam::InverseTime:
+            result = gc_state.modal.feed_rate == FeedRate::InverseTime;
+            return true;
+        case SysParam::UnitsPerMinute:
+            result = gc_state.modal.feed_rate == FeedRate::UnitsPerMin;
+            return true;
+        case SysParam::UnitsPerRev:
+            // result = gc_state.modal.feed_rate == FeedRate::UnitsPerRev;
+            result = 0.0;
+            return true;
     }
-
     return false;
 }
 
-bool system_param_exists(const std::string& name) {
-    float dummy;
-    return get_system_param(name, dummy);
+static bool system_param_exists(param_name_t name) {
+    int axis;
+    return ParamNames::system_param(name, axis) != SysParam::None;
 }
 
 // The LinuxCNC doc says that the EXISTS syntax is like EXISTS[#<_foo>]
@@ -391,41 +319,29 @@ bool named_param_exists(std::string& name) {
         float dummy;
         return get_config_item(search, dummy);
     }
+    auto handle = ParamNames::intern(search);
     if (search[0] == '_') {
-        float dummy;
-        bool  got = get_system_param(search, dummy);
-        if (got) {
-            return true;
-        }
-        return global_named_params.count(search) != 0;
+        return system_param_exists(handle) || global_named_params.exists(handle);
     }
     // If the name does not start with _ it is local so we look for a job-local parameter
     // If no job is active, we treat the interpretive context like a local context
-    return Job::active() ? Job::param_exists(search) : global_named_params.count(search) != 0;
-}
-
-bool get_global_named_param(const std::string& name, float& value) {
-    auto it = global_named_params.find(name);
-    if (it == global_named_params.end()) {
-        return false;
-    }
-    value = it->second;
-    return true;
+    return Job::active() ? Job::param_exists(handle) : global_named_params.exists(handle);
 }
 
 bool get_param(const param_ref_t& param_ref, float& value) {
     auto name = param_ref.name;
-    if (name.length()) {
-        if (name[0] == '/') {
-            return get_config_item(name, value);
+    if (name != no_param_name) {
+        auto& text = ParamNames::name(name);
+        if (text[0] == '/') {
+            return get_config_item(text, value);
         }
-        if (name[0] == '_') {
+        if (text[0] == '_') {
             if (get_system_param(name, value)) {
                 return true;
             }
-            return get_global_named_param(name, value);
+            return global_named_params.get(name, value);
         }
-        return Job::active() ? Job::get_param(name, value) : get_global_named_param(name, value);
+        return Job::active() ? Job::get_param(name, value) : global_named_params.get(name, value);
     }
     return get_numbered_param(param_ref.id, value);
 }
@@ -450,13 +366,19 @@ bool get_param_ref(const char* line, size_t& pos, param_ref_t& param_ref) {
         }
             param_ref.id = result;
             return true;
-        case '<':
-            // Named parameter
+        case '<': {
+            // Named parameter, interned so later references need no strings
+            char   name[maxParamName];
+            size_t len = 0;
             ++pos;
             while ((c = line[pos]) && c != '>') {
                 ++pos;
                 if (!isspace(c)) {
-                    param_ref.name += toupper(c);
+                    if (len == maxParamName) {
+                        log_debug("Parameter name too long");
+                        return false;
+                    }
+                    name[len++] = toupper(c);
                 }
             }
             if (!c) {
@@ -464,7 +386,13 @@ bool get_param_ref(const char* line, size_t& pos, param_ref_t& param_ref) {
                 return false;
             }
             ++pos;
+            if (!len) {
+                log_debug("Empty parameter name");
+                return false;
+            }
+            param_ref.name = ParamNames::intern(std::string_view(name, len));
             return true;
+        }
         case '[': {
             // Expression evaluating to param number
             Error status = expression(line, pos, result);
@@ -486,7 +414,7 @@ bool get_param_ref(const char* line, size_t& pos, param_ref_t& param_ref) {
 }
 
 bool set_named_param(const std::string& name, float value) {
-    global_named_params[name] = value;
+    global_named_params.set(ParamNames::intern(name), value);
     return true;
 }
 
@@ -523,20 +451,46 @@ bool set_numbered_param(ngc_param_id_t id, float value) {
     return false;
 }
 
+void push_local_params(LocalParams& saved, const float* args, size_t n_args) {
+    saved.defined = 0;
+    for (int i = 0; i < n_local_params; ++i) {
+        if (auto param = float_params.find(i + 1); param != float_params.end()) {
+            saved.values[i] = param->second;
+            set_bitnum(saved.defined, i);
+            float_params.erase(param);
+        }
+    }
+    for (size_t i = 0; i < n_args && i < n_local_params; ++i) {
+        float_params[i + 1] = args[i];
+    }
+}
+
+void pop_local_params(const LocalParams& saved) {
+    for (int i = 0; i < n_local_params; ++i) {
+        if (bitnum_is_true(saved.defined, i)) {
+            float_params[i + 1] = saved.values[i];
+        } else {
+            float_params.erase(i + 1);
+        }
+    }
+}
+
 bool set_param(const param_ref_t& param_ref, float value) {
-    if (param_ref.name.length()) {  // Named parameter
-        auto name = param_ref.name;
-        if (name[0] == '/') {
-            return set_config_item(param_ref.name, value);
+    if (param_ref.name != no_param_name) {  // Named parameter
+        auto  name = param_ref.name;
+        auto& text = ParamNames::name(name);
+        if (text[0] == '/') {
+            return set_config_item(text, value);
         }
-        if (name[0] != '_' && Job::active()) {
+        if (text[0] != '_' && Job::active()) {
             return Job::set_param(name, value);
         }
-        if (name[0] == '_' && system_param_exists(name)) {
-            log_debug("Attempt to set read-only parameter " << name);
+        if (text[0] == '_' && system_param_exists(name)) {
+            log_debug("Attempt to set read-only parameter " << text);
             return false;
         }
-        return set_named_param(name, value);
+        global_named_params.set(name, value);
+        return true;
     }
 
     if (ngc_param_is_rw(param_ref.id)) {  // Numbered parameter
@@ -546,6 +500,18 @@ bool set_param(const param_ref_t& param_ref, float value) {
     return false;
 }
 
+bool read_param(const param_ref_t& param_ref, float& result) {
+    if (get_param(param_ref, result)) {
+        return true;
+    }
+    if (param_ref.name != no_param_name) {
+        log_debug("Undefined parameter " << ParamNames::name(param_ref.name));
+    } else {
+        log_debug("Undefined parameter " << param_ref.id);
+    }
+    return false;
+}
+
 // Gets a numeric value, either a literal number or a #-prefixed parameter value
 bool read_number(const char* line, size_t& pos, float& result, bool in_expression) {
     char c = line[pos];
@@ -555,11 +521,7 @@ bool read_number(const char* line, size_t& pos, float& result, bool in_expressio
         if (!get_param_ref(line, pos, param_ref)) {
             return false;
         }
-        if (get_param(param_ref, result)) {
-            return true;
-        }
-        log_debug("Undefined parameter " << param_ref.name);
-        return false;
+        return read_param(param_ref, result);
     }
     if (c == '[') {
         Error status = expression(line, pos, result);
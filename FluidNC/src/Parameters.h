@@ -3,6 +3,8 @@
 
 #pragma once
 
+#include "ParamNames.h"
+
 #include <stddef.h>
 #include <string>
 
@@ -10,9 +12,33 @@
 // possible
 typedef int ngc_param_id_t;
 
+struct param_ref_t {
+    param_name_t   name = no_param_name;  // Interned name of a named parameter
+    ngc_param_id_t id   = 0;              // Valid if name is no_param_name
+};
+
+// Parses the reference after a #, which can be a number, a <name>, or
+// an indirection through another # or an [expression]
+bool get_param_ref(const char* line, size_t& pos, param_ref_t& param_ref);
+
+// Gets the value of a parameter, logging a message if it is undefined
+bool read_param(const param_ref_t& param_ref, float& result);
+
 bool assign_param(const char* line, size_t& pos);
 bool read_number(const char* line, size_t& pos, float& value, bool in_expression = false);
 bool perform_assignments();
 bool named_param_exists(std::string& name);
-bool set_named_param(const char* name, float value);
+bool set_named_param(const std::string& name, float value);
 bool set_numbered_param(ngc_param_id_t, float value);
+
+// #1-#30 are local to O-word subroutines.  A call saves them and sets them
+// from the call arguments, and the return restores them.
+const int n_local_params = 30;
+
+struct LocalParams {
+    float    values[n_local_params];
+    uint32_t defined;  // Bit mask of the saved values that were defined
+};
+
+void push_local_params(LocalParams& saved, const float* args, size_t n_args);
+void pop_local_params(const LocalParams& saved);
@@ -21,7 +21,6 @@ class Probe : public Configuration::Configurable {
         void trigger(bool active) override {
             update(active);
             protocol_send_event(_event, this);
-            report_recompute_pin_string();
         }
     };
 
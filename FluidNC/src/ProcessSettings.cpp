@@ -22,6 +22,8 @@
 #include "StartupLog.h"           // startupLog
 #include "Driver/gpio_dump.h"     // gpio_dump()
 #include "FileCommands.h"         // make_file_commands()
+#include "LogPool.h"              // LogPool::drops()
+#include "Backup.h"               // Backup::save()
 
 #include "FluidPath.h"
 #include "HashFS.h"
@@ -38,6 +40,16 @@ static Error switchInchMM(const char* value, AuthenticationLevel auth_level, Cha
 
 static Error fakeMaxSpindleSpeed(const char* value, AuthenticationLevel auth_level, Channel& out);
 
+static const char* default_backup = "backup.fnb";
+
+static Error backup(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return Backup::save(value && *value ? value : default_backup, out);
+}
+
+static Error restore_backup(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return Backup::restore(value && *value ? value : default_backup, out);
+}
+
 static Error report_init_message_cmd(const char* value, AuthenticationLevel auth_level, Channel& out);
 
 // If authentication is disabled, auth_level will be LEVEL_ADMIN
@@ -690,6 +702,10 @@ static Error macros_run(const char* value, AuthenticationLevel auth_level, Chann
     return Error::InvalidStatement;
 }
 
+static Error reload_config(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    return Machine::MachineConfig::reload(out);
+}
+
 static Error dump_config(const char* value, AuthenticationLevel auth_level, Channel& out) {
     Channel* ss;
     if (value) {
@@ -885,6 +901,97 @@ static Error setReportInterval(const char* value, AuthenticationLevel auth_level
     return Error::Ok;
 }
 
+static const EnumItem reportFieldNames[] = {
+    { StatusPos, "Pos" }, { StatusBf, "Bf" }, { StatusLn, "Ln" }, { StatusFS, "FS" }, { StatusPn, "Pn" },
+    { StatusWCO, "WCO" }, { StatusOv, "Ov" }, { StatusJob, "Job" }, EnumItem(0),
+};
+
+static Error setReportFields(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    ReportOptions options = out.reportOptions();
+    if (!value) {
+        LogStream msg(out, "$Report/Fields=");
+        const char* delim = "";
+        for (const EnumItem* e = reportFieldNames; e->name; ++e) {
+            if (options.fields & e->value) {
+                msg << delim << e->name;
+                delim = ",";
+            }
+        }
+        return Error::Ok;
+    }
+    std::string_view rest(value);
+    std::string_view name;
+    uint16_t         fields = 0;
+    while (string_util::split_prefix(rest, name, ',')) {
+        if (string_util::equal_ignore_case(name, "all")) {
+            fields |= AllStatusFields;
+            continue;
+        }
+        const EnumItem* e;
+        for (e = reportFieldNames; e->name; ++e) {
+            if (string_util::equal_ignore_case(name, e->name)) {
+                fields |= e->value;
+                break;
+            }
+        }
+        if (!e->name) {
+            log_error_to(out, "Unknown report field " << name);
+            return Error::InvalidValue;
+        }
+    }
+    options.fields = fields;
+    out.setReportOptions(options);
+    return Error::Ok;
+}
+
+static Error setReportPrecision(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    ReportOptions options = out.reportOptions();
+    if (!value) {
+        if (options.precision < 0) {
+            log_stream(out, "$Report/Precision=default");
+        } else {
+            log_stream(out, "$Report/Precision=" << options.precision);
+        }
+        return Error::Ok;
+    }
+    int32_t precision;
+    if (string_util::equal_ignore_case(value, "default")) {
+        precision = -1;
+    } else if (!string_util::is_int(value, precision) || precision < 0 || precision > 6) {
+        return Error::NumberRange;
+    }
+    options.precision = precision;
+    out.setReportOptions(options);
+    return Error::Ok;
+}
+
+static const EnumItem reportModeNames[] = {
+    { int(ReportMode::Full), "Full" },
+    { int(ReportMode::Delta), "Delta" },
+    { int(ReportMode::Binary), "Binary" },
+    EnumItem(int(ReportMode::Full)),
+};
+
+static Error setReportMode(const char* value, AuthenticationLevel auth_level, Channel& out) {
+    ReportOptions options = out.reportOptions();
+    if (!value) {
+        for (const EnumItem* e = reportModeNames; e->name; ++e) {
+            if (e->value == int(options.mode)) {
+                log_stream(out, "$Report/Mode=" << e->name);
+            }
+        }
+        return Error::Ok;
+    }
+    for (const EnumItem* e = reportModeNames; e->name; ++e) {
+        if (string_util::equal_ignore_case(value, e->name)) {
+            options.mode = ReportMode(e->value);
+            out.setReportOptions(options);
+            return Error::Ok;
+        }
+    }
+    return Error::InvalidValue;
+}
+
 static Error sendAlarm(const char* value, AuthenticationLevel auth_level, Channel& out) {
     int       intValue = value ? atoi(value) : 0;
     ExecAlarm alarm    = static_cast<ExecAlarm>(intValue);
@@ -895,6 +1002,8 @@ static Error sendAlarm(const char* value, AuthenticationLevel auth_level, Channe
 
 static Error showHeap(const char* value, AuthenticationLevel auth_level, Channel& out) {
     log_info("Heap free: " << xPortGetFreeHeapSize() << " min: " << heapLowWater);
+    log_info("Log buffers: " << LogPool::in_use() << "/" << LogPool::n_buffers << " in use, max: " << LogPool::high_water()
+                             << " dropped: " << LogPool::drops() << " heap fallbacks: " << LogPool::heap_fallbacks());
     return Error::Ok;
 }
 
@@ -908,6 +1017,9 @@ void make_user_commands() {
 
     new UserCommand("CI", "Channel/Info", showChannelInfo, anyState);
     new UserCommand("CD", "Config/Dump", dump_config, anyState);
+    new UserCommand("CR", "Config/Reload", reload_config, notIdleOrAlarm);
+    new UserCommand("BU", "Backup", backup, notIdleOrAlarm, WU);
+    new UserCommand("BR", "Restore", restore_backup, notIdleOrAlarm, WA);
     new UserCommand("", "Help", show_help, anyState);
     new UserCommand("T", "State", showState, anyState);
 
@@ -957,6 +1069,9 @@ void make_user_commands() {
     new UserCommand("UP", "Uart/Passthrough", uartPassthrough, notIdleOrAlarm);
 
     new UserCommand("RI", "Report/Interval", setReportInterval, anyState);
+    new UserCommand("RF", "Report/Fields", setReportFields, anyState);
+    new UserCommand("RP", "Report/Precision", setReportPrecision, anyState);
+    new UserCommand("RMO", "Report/Mode", setReportMode, anyState);
 
     new UserCommand("13", "Report/Inches", switchInchMM, notIdleOrAlarm);
 
@@ -998,6 +1113,18 @@ char* normalize_key(char* start) {
     return start;
 }
 
+// Indexes of the commands by either name, and of the settings by each kind of name
+static WordIndex<Command> commandIndex(true, true);
+static WordIndex<Setting> settingNameIndex(true, false);
+static WordIndex<Setting> settingGrblIndex(false, true);
+
+// Called at the end of startup, once modules have added their commands and settings
+void build_word_indexes() {
+    commandIndex.build(Command::List);
+    settingNameIndex.build(Setting::List);
+    settingGrblIndex.build(Setting::List);
+}
+
 // This is the handler for all forms of settings commands,
 // $..= and [..], with and without a value.
 Error do_command_or_setting(const char* key, const char* value, AuthenticationLevel auth_level, Channel& out) {
@@ -1009,16 +1136,14 @@ Error do_command_or_setting(const char* key, const char* value, AuthenticationLe
     // Try to execute a command.  Commands handle values internally;
     // you cannot determine whether to set or display solely based on
     // the presence of a value.
-    for (Command* cp : Command::List) {
-        if ((strcasecmp(cp->getName(), key) == 0) || (cp->getGrblName() && strcasecmp(cp->getGrblName(), key) == 0)) {
-            if (auth_failed(cp, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (cp->synchronous()) {
-                protocol_buffer_synchronize();
-            }
-            return cp->action(value, auth_level, out);
+    if (Command* cp = commandIndex.find(Command::List, key)) {
+        if (auth_failed(cp, value, auth_level)) {
+            return Error::AuthenticationFailed;
+        }
+        if (cp->synchronous()) {
+            protocol_buffer_synchronize();
         }
+        return cp->action(value, auth_level, out);
     }
 
     // First search the yaml settings by name. If found, set a new
@@ -1055,33 +1180,29 @@ Error do_command_or_setting(const char* key, const char* value, AuthenticationLe
 
     // Next search the settings list by text name. If found, set a new
     // value if one is given, otherwise display the current value
-    for (Setting* s : Setting::List) {
-        if (strcasecmp(s->getName(), key) == 0) {
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (value) {
-                return s->setStringValue(uriDecode(value));
-            } else {
-                show_setting(s->getName(), s->getStringValue(), NULL, out);
-                return Error::Ok;
-            }
+    if (Setting* s = settingNameIndex.find(Setting::List, key)) {
+        if (auth_failed(s, value, auth_level)) {
+            return Error::AuthenticationFailed;
+        }
+        if (value) {
+            return s->setStringValue(uriDecode(value));
+        } else {
+            show_setting(s->getName(), s->getStringValue(), NULL, out);
+            return Error::Ok;
         }
     }
 
     // Then search the setting list by compatible name.  If found, set a new
     // value if one is given, otherwise display the current value in compatible mode
-    for (Setting* s : Setting::List) {
-        if (s->getGrblName() && strcasecmp(s->getGrblName(), key) == 0) {
-            if (auth_failed(s, value, auth_level)) {
-                return Error::AuthenticationFailed;
-            }
-            if (value) {
-                return s->setStringValue(uriDecode(value));
-            } else {
-                show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
-                return Error::Ok;
-            }
+    if (Setting* s = settingGrblIndex.find(Setting::List, key)) {
+        if (auth_failed(s, value, auth_level)) {
+            return Error::AuthenticationFailed;
+        }
+        if (value) {
+            return s->setStringValue(uriDecode(value));
+        } else {
+            show_setting(s->getGrblName(), s->getCompatibleValue(), NULL, out);
+            return Error::Ok;
         }
     }
 
@@ -20,6 +20,7 @@
 #include "SettingsDefinitions.h"  // gcode_echo
 #include "Machine/LimitPin.h"
 #include "Job.h"
+#include "LogPool.h"
 #include "Driver/restart.h"
 
 volatile ExecAlarm lastAlarm;  // The most recent alarm code
@@ -100,18 +101,42 @@ void drain_messages() {
     }
 }
 
+// Messages are handed to the channel as complete newline-terminated lines,
+// so a broadcast to allChannels is written to every channel from a single
+// buffer.  Pooled messages already end with a newline; others are copied
+// once into fixed_line here rather than once per destination channel.
 void output_loop(void* unused) {
+    static char fixed_line[MAX_MESSAGE_LINE];
     while (true) {
         // Block until a message is received
         LogMessage message;
         if (xQueueReceive(message_queue, &message, portMAX_DELAY)) {
-            if (message.isString) {
-                std::string* s = static_cast<std::string*>(message.line);
-                message.channel->print_msg(message.level, s->c_str());
-                delete s;
-            } else {
-                const char* cp = static_cast<const char*>(message.line);
-                message.channel->print_msg(message.level, cp);
+            switch (message.kind) {
+                case LogMessage::Kind::Pooled: {
+                    LogBuffer* buf = static_cast<LogBuffer*>(message.line);
+                    // If the claim fails, the buffer was dropped to make room for a newer message
+                    if (LogPool::claim(buf, message.ticket)) {
+                        message.channel->print_line(message.level, buf->text, buf->len);
+                        LogPool::release(buf);
+                    }
+                } break;
+                case LogMessage::Kind::String: {
+                    std::string* s = static_cast<std::string*>(message.line);
+                    *s += '\n';
+                    message.channel->print_line(message.level, s->c_str(), s->length());
+                    delete s;
+                } break;
+                case LogMessage::Kind::Fixed: {
+                    const char* cp  = static_cast<const char*>(message.line);
+                    size_t      len = strlen(cp);
+                    if (len < sizeof(fixed_line) - 1) {
+                        memcpy(fixed_line, cp, len);
+                        fixed_line[len++] = '\n';
+                        message.channel->print_line(message.level, fixed_line, len);
+                    } else {
+                        message.channel->print_msg(message.level, cp);
+                    }
+                } break;
             }
         }
     }
@@ -137,6 +162,7 @@ void polling_loop(void* unused) {
         // Polling with an argument both checks for realtime characters and
         // returns a line-oriented command if one is ready.
         pollChannels();
+        allChannels.dispatchReports();
         for (auto const& module : Modules()) {
             module->poll();
         }
@@ -168,7 +194,7 @@ void polling_loop(void* unused) {
                 // A job channel is active, so accept line-oriented input only
                 // from the job channel on top of the job stack.
                 auto channel = Job::channel();
-                auto status  = channel->pollLine(activeLine);
+                auto status  = Job::source()->pollLine(activeLine);
                 switch (status) {
                     case Error::Ok:
                         activeChannel = channel;
@@ -272,6 +298,9 @@ uint32_t heapLowWater           = UINT_MAX;
 uint32_t heapLowWaterReported   = UINT_MAX;
 int32_t  heapLowWaterReportTime = 0;
 
+static uint32_t logDropsReported   = 0;
+static int32_t  logDropsReportTime = 0;
+
 void protocol_main_loop() {
     start_polling();
 
@@ -322,6 +351,10 @@ void protocol_main_loop() {
             idleEndTime = 0;  //
             Axes::set_disable(true);
         }
+
+        // Write coordinate system changes to NVS as soon as no motion is planned
+        Coordinates::flush();
+
         uint32_t newHeapSize = xPortGetFreeHeapSize();
         if (newHeapSize < heapLowWater) {
             heapLowWater = newHeapSize;
@@ -341,6 +374,14 @@ void protocol_main_loop() {
                 heapLowWaterReportTime = getCpuTicks();
             }
         }
+        // Report dropped log messages at most every few seconds, since the
+        // report is itself a message that competes for the same buffers.
+        uint32_t logDrops = LogPool::drops();
+        if (logDrops != logDropsReported && uint32_t(getCpuTicks() - logDropsReportTime) > usToCpuTicks(5000000)) {
+            log_warn("Log overflow: " << (logDrops - logDropsReported) << " messages dropped");
+            logDropsReported   = logDrops;
+            logDropsReportTime = getCpuTicks();
+        }
     }
     return; /* Never reached */
 }
@@ -396,6 +437,11 @@ static void protocol_do_start_homing(){
     Machine::Homing::run_cycles(Machine::Homing::AllCycles);
 }
 
+static void protocol_do_full_reset() {
+    Coordinates::flush(true);
+    restart();
+}
+
 static void protocol_do_soft_restart() {
     // Reset primary systems.
     system_reset();
@@ -690,6 +736,9 @@ static void protocol_do_initiate_cycle() {
     sys.step_control = {};  // Restore step control to normal operation
     plan_block_t* pb;
     if ((pb = plan_get_current_block()) && !sys.suspend.bit.motionCancel) {
+        // The machine is still stopped, so coordinate changes made while the
+        // blocks were queued can be written now instead of after the cycle
+        Coordinates::flush(true);
         sys.suspend.value = 0;  // Break suspend state.
         set_state(pb->is_jog ? State::Jog : State::Cycle);
         Stepper::prep_buffer();  // Initialize step segment buffer before beginning cycle.
@@ -1159,7 +1208,7 @@ const NoArgEvent sleepEvent { protocol_do_sleep };
 const NoArgEvent debugEvent { report_realtime_debug };
 const NoArgEvent startEvent { protocol_do_start };
 const NoArgEvent restartEvent { protocol_do_soft_restart };
-const NoArgEvent fullResetEvent { restart };
+const NoArgEvent fullResetEvent { protocol_do_full_reset };
 const NoArgEvent runStartupLinesEvent { protocol_run_startup_lines };
 const NoArgEvent homingButtonEvent { protocol_do_start_homing };
 
@@ -1172,8 +1221,11 @@ const ArgEvent alarmEvent { (void (*)(void*))protocol_do_alarm };
 xQueueHandle event_queue;
 
 void protocol_init() {
+    // The message queue is deeper than the LogPool so that, under a burst of
+    // log messages, the pool overflows - dropping the oldest messages - before
+    // the queue fills up and blocks protocol output.
     event_queue   = xQueueCreate(10, sizeof(EventItem));
-    message_queue = xQueueCreate(10, sizeof(LogMessage));
+    message_queue = xQueueCreate(LogPool::n_buffers + 16, sizeof(LogMessage));
 }
 
 void IRAM_ATTR protocol_send_event_from_ISR(const Event* evt, void* arg) {
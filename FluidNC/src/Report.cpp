@@ -30,11 +30,14 @@
 #include "WebUI/NotificationsService.h"  // WebUI::notificationsService
 #include "InputFile.h"
 #include "Job.h"
+#include "StatusSnapshot.h"
+#include "LogPool.h"  // LogBuffer
 
 #include <map>
 #include <freertos/task.h>
 #include <cstring>
 #include <cstdio>
+#include <cmath>
 #include <cstdarg>
 #include <sstream>
 #include <iomanip>
@@ -45,8 +48,6 @@ EspClass esp;
 
 volatile bool protocol_pin_changed = false;
 
-std::string report_pin_string;
-
 portMUX_TYPE mmux = portMUX_INITIALIZER_UNLOCKED;
 
 void notifyf(const char* title, const char* format, ...) {
@@ -476,79 +477,189 @@ const char* state_name() {
     return "";
 }
 
-void report_recompute_pin_string() {
-    report_pin_string = "";
-    if (config->_probe->get_state()) {
-        report_pin_string += 'P';
+// Define this to do something if a debug request comes in over serial
+void report_realtime_debug() {}
+
+// Returns the value of an axis in the units used by status reports, and sets
+// decimals to the number of decimal places it is reported with.
+static float report_axis_value(size_t axis, float value, int precision, int& decimals) {
+    decimals = 3;
+    if (axis < A_AXIS || axis > C_AXIS) {
+        // Rotary axes are in degrees so mm vs inch is not relevant.
+        if (config->_reportInches) {
+            value /= MM_PER_INCH;
+            decimals = 4;
+        }
+    }
+    if (precision >= 0) {
+        decimals = precision;
     }
+    return value;
+}
+
+static const float report_powers_of_10[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f };
 
+// An axis value as an integer count of the smallest reported unit.
+// Delta reports compare these so that changes below the reported
+// resolution do not cause a field to be resent.
+static int32_t report_axis_units(size_t axis, float value, int precision) {
+    int decimals;
+    value = report_axis_value(axis, value, precision, decimals);
+    return lroundf(value * report_powers_of_10[decimals]);
+}
+
+static bool report_axes_differ(const float* a, const float* b, int precision) {
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        if (report_axis_units(axis, a[axis], precision) != report_axis_units(axis, b[axis], precision)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Like report_util_axis_values(), but prints directly to the stream
+// without building an intermediate string.
+static void report_print_axis_values(Print& out, const float* axis_value, int precision) {
+    auto n_axis = Axes::_numberAxis;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        if (axis) {
+            out << ',';
+        }
+        int   decimals;
+        float value = report_axis_value(axis, axis_value[axis], precision, decimals);
+        out.print(value, decimals);
+    }
+}
+
+static uint32_t report_hash(const std::string& s) {
+    // FNV-1a
+    uint32_t hash = 2166136261u;
+    for (char c : s) {
+        hash = (hash ^ uint8_t(c)) * 16777619u;
+    }
+    return hash ? hash : 1;  // 0 means no job
+}
+
+// The letters of the active probe, limit and control pins for the Pn: field
+static void report_capture_pins(char* pins, size_t size) {
+    size_t n   = 0;
+    auto   add = [&](char c) {
+        if (n < size - 1) {
+            pins[n++] = c;
+        }
+    };
+    if (config->_probe->get_state()) {
+        add('P');
+    }
     MotorMask lim_pin_state = limits_get_state();
     if (lim_pin_state) {
         auto n_axis = Axes::_numberAxis;
         for (size_t axis = 0; axis < n_axis; axis++) {
             if (bitnum_is_true(lim_pin_state, Machine::Axes::motor_bit(axis, 0)) ||
                 bitnum_is_true(lim_pin_state, Machine::Axes::motor_bit(axis, 1))) {
-                report_pin_string += Axes::axisName(axis);
+                add(Axes::axisName(axis));
             }
         }
     }
-
-    std::string ctrl_pin_report = config->_control->report_status();
-    if (ctrl_pin_report.length()) {
-        report_pin_string += ctrl_pin_report;
+    for (auto pin : config->_control->_pins) {
+        if (pin->get()) {
+            add(pin->letter());
+        }
     }
+    pins[n] = '\0';
 }
 
-// Define this to do something if a debug request comes in over serial
-void report_realtime_debug() {}
-
-// Prints real-time data. This function grabs a real-time snapshot of the stepper subprogram
-// and the actual location of the CNC machine. Users may change the following function to their
-// specific needs, but the desired real-time data report must be as short as possible. This is
-// requires as it minimizes the computational overhead to keep running smoothly,
-// especially during g-code programs with fast, short line segments and high frequency reports (5-20Hz).
-void report_realtime_status(Channel& channel) {
-    LogStream msg(channel, "<");
-    msg << state_name();
+// Captures the values that a status report is formatted from.  This is
+// normally called only by StatusSnapshot::update(); consumers read the
+// shared snapshot instead.
+void report_capture_status(StatusValues& values) {
+    values.state = state_name();
 
-    // Report position
-    float* print_position = get_mpos();
-    if (bits_are_true(status_mask->get(), RtStatus::Position)) {
-        msg << "|MPos:";
-    } else {
-        msg << "|WPos:";
-        mpos_to_wpos(print_position);
+    float* mpos = get_mpos();
+    values.mpos = bits_are_true(status_mask->get(), RtStatus::Position);
+    memcpy(values.pos, mpos, sizeof(values.pos));
+    if (!values.mpos) {
+        mpos_to_wpos(values.pos);
     }
-    msg << report_util_axis_values(print_position).c_str();
 
-    // Returns planner and serial read buffer states.
-
-    if (bits_are_true(status_mask->get(), RtStatus::Buffer)) {
-        msg << "|Bf:" << plan_get_block_buffer_available() << "," << channel.rx_buffer_available();
-    }
+    values.planner_available = plan_get_block_buffer_available();
 
+    values.line_number = 0;
     if (config->_useLineNumbers) {
-        // Report current line number
         plan_block_t* cur_block = plan_get_current_block();
         if (cur_block != NULL) {
-            uint32_t ln = cur_block->line_number;
-            if (ln > 0) {
-                msg << "|Ln:" << ln;
-            }
+            values.line_number = cur_block->line_number;
         }
     }
 
-    // Report realtime feed speed
-    float rate = Stepper::get_realtime_rate();
+    values.feed_rate = Stepper::get_realtime_rate();
     if (config->_reportInches) {
-        rate /= MM_PER_INCH;
+        values.feed_rate /= MM_PER_INCH;
+    }
+    values.spindle_speed = sys.spindle_speed;
+
+    report_capture_pins(values.pins, sizeof(values.pins));
+
+    memcpy(values.wco, get_wco(), sizeof(values.wco));
+
+    values.overrides[0] = sys.f_override;
+    values.overrides[1] = sys.r_override;
+    values.overrides[2] = sys.spindle_speed_ovr;
+
+    values.accessories         = 0;
+    SpindleState sp_state      = spindle->get_state();
+    CoolantState coolant_state = config->_coolant->get_state();
+    if (sp_state == SpindleState::Cw) {
+        values.accessories |= AccessorySpindleCw;
+    }
+    if (sp_state == SpindleState::Ccw) {
+        values.accessories |= AccessorySpindleCcw;
+    }
+    if (coolant_state.Flood) {
+        values.accessories |= AccessoryFlood;
     }
-    msg << "|FS:" << setprecision(0) << rate << "," << sys.spindle_speed;
+    if (coolant_state.Mist) {
+        values.accessories |= AccessoryMist;
+    }
+
+    values.job_hash = Job::active() ? report_hash(Job::channel()->_progress) : 0;
+}
 
-    if (report_pin_string.length()) {
-        msg << "|Pn:" << report_pin_string;
+// Returns the subset of fields whose values differ from the previous report
+static uint16_t report_changed_fields(const StatusValues& now, const StatusValues& last, uint16_t fields, int precision) {
+    uint16_t changed = 0;
+    if (now.mpos != last.mpos || report_axes_differ(now.pos, last.pos, precision)) {
+        changed |= StatusPos;
+    }
+    if (now.planner_available != last.planner_available) {
+        changed |= StatusBf;
+    }
+    if (now.line_number != last.line_number) {
+        changed |= StatusLn;
+    }
+    if (lroundf(now.feed_rate) != lroundf(last.feed_rate) || now.spindle_speed != last.spindle_speed) {
+        changed |= StatusFS;
+    }
+    if (strcmp(now.pins, last.pins)) {
+        changed |= StatusPn;
+    }
+    if (report_axes_differ(now.wco, last.wco, precision)) {
+        changed |= StatusWCO;
+    }
+    if (memcmp(now.overrides, last.overrides, sizeof(now.overrides)) || now.accessories != last.accessories) {
+        changed |= StatusOv;
+    }
+    if (now.job_hash != last.job_hash) {
+        changed |= StatusJob;
     }
+    return changed & fields;
+}
 
+// Decides whether a Full mode report carries the WCO and Ov fields.  They
+// change rarely, so they are sent only every few reports.
+static uint16_t report_periodic_fields() {
+    uint16_t fields = 0;
     if (report_wco_counter > 0) {
         report_wco_counter--;
     } else {
@@ -566,7 +677,7 @@ void report_realtime_status(Channel& channel) {
         if (report_ovr_counter == 0) {
             report_ovr_counter = 1;  // Set override on next report.
         }
-        msg << "|WCO:" << report_util_axis_values(get_wco()).c_str();
+        fields |= StatusWCO;
     }
 
     if (report_ovr_counter > 0) {
@@ -583,36 +694,67 @@ void report_realtime_status(Channel& channel) {
                 report_ovr_counter = (REPORT_OVR_REFRESH_IDLE_COUNT - 1);
                 break;
         }
+        fields |= StatusOv;
+    }
+    return fields;
+}
+
+// rx_available is the Bf: value for the destination channel.
+static void report_status_text(Print& msg, const StatusValues& values, uint16_t fields, int precision, int rx_available, bool delta) {
+    msg << "<" << values.state;
+
+    if (fields & StatusPos) {
+        msg << (values.mpos ? "|MPos:" : "|WPos:");
+        report_print_axis_values(msg, values.pos, precision);
+    }
+
+    // Returns planner and serial read buffer states.
+    if ((fields & StatusBf) && bits_are_true(status_mask->get(), RtStatus::Buffer)) {
+        msg << "|Bf:" << values.planner_available << "," << rx_available;
+    }
+
+    if ((fields & StatusLn) && (values.line_number > 0 || delta)) {
+        msg << "|Ln:" << values.line_number;
+    }
+
+    if (fields & StatusFS) {
+        msg << "|FS:" << setprecision(0) << values.feed_rate << "," << values.spindle_speed;
+    }
+
+    if ((fields & StatusPn) && (values.pins[0] || delta)) {
+        msg << "|Pn:" << values.pins;
+    }
 
-        msg << "|Ov:" << int(sys.f_override) << "," << int(sys.r_override) << "," << int(sys.spindle_speed_ovr);
-        SpindleState sp_state      = spindle->get_state();
-        CoolantState coolant_state = config->_coolant->get_state();
-        if (sp_state != SpindleState::Disable || coolant_state.Mist || coolant_state.Flood) {
+    if (fields & StatusWCO) {
+        msg << "|WCO:";
+        report_print_axis_values(msg, values.wco, precision);
+    }
+
+    if (fields & StatusOv) {
+        msg << "|Ov:" << int(values.overrides[0]) << "," << int(values.overrides[1]) << "," << int(values.overrides[2]);
+        uint8_t acc = values.accessories;
+        if (acc || delta) {
             msg << "|A:";
-            switch (sp_state) {
-                case SpindleState::Disable:
-                    break;
-                case SpindleState::Cw:
-                    msg << "S";
-                    break;
-                case SpindleState::Ccw:
-                    msg << "C";
-                    break;
-                case SpindleState::Unknown:
-                    break;
+            if (acc & AccessorySpindleCw) {
+                msg << "S";
             }
-
-            auto coolant = coolant_state;
-            if (coolant.Flood) {
+            if (acc & AccessorySpindleCcw) {
+                msg << "C";
+            }
+            if (acc & AccessoryFlood) {
                 msg << "F";
             }
-            if (coolant.Mist) {
+            if (acc & AccessoryMist) {
                 msg << "M";
             }
         }
     }
-    if (Job::active()) {
-        msg << "|" << Job::channel()->_progress;
+    if (fields & StatusJob) {
+        if (Job::active()) {
+            msg << "|" << Job::channel()->_progress;
+        } else if (delta) {
+            msg << "|SD:";  // The job has ended
+        }
     }
 #ifdef DEBUG_STEPPER_ISR
     msg << "|ISRs:" << Stepper::isr_count;
@@ -621,9 +763,274 @@ void report_realtime_status(Channel& channel) {
     msg << "|Heap:" << xPortGetFreeHeapSize();
 #endif
     msg << ">";
+}
+
+static void report_status_text(Channel& channel, const StatusValues& values, uint16_t fields, bool delta) {
+    LogStream msg(channel, MsgLevelNone);
+    report_status_text(msg, values, fields, channel.reportOptions().precision, channel.rx_buffer_available(), delta);
     // The destructor sends the line when msg goes out of scope
 }
 
+// A text status report formatted once, to be sent to several channels.
+// A report that is too long for the buffer, like one with many axes and
+// a long file name, moves to the heap.
+class StatusLine : public Print {
+    char        _buf[LogBuffer::max_text];
+    size_t      _len = 0;
+    std::string _long;
+
+public:
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* buffer, size_t length) override {
+        if (_long.empty() && _len + length <= sizeof(_buf)) {
+            memcpy(_buf + _len, buffer, length);
+            _len += length;
+            return length;
+        }
+        if (_long.empty()) {
+            _long.assign(_buf, _len);
+        }
+        _long.append(reinterpret_cast<const char*>(buffer), length);
+        return length;
+    }
+    void send(Channel& channel) {
+        LogStream msg(channel, MsgLevelNone);
+        if (_long.empty()) {
+            msg.write(reinterpret_cast<const uint8_t*>(_buf), _len);
+        } else {
+            msg.write(reinterpret_cast<const uint8_t*>(_long.data()), _long.length());
+        }
+    }
+};
+
+// Little-endian packing for binary status frames.  Each field is started
+// with field(), which sets its bit in the mask.  If the field does not fit
+// in the payload, the frame is sent first and the field goes in another
+// frame with the same header, so no frame ever claims a field it lacks.
+class StatusFrame {
+    Channel&    _channel;
+    const char* _state;
+    uint16_t    _flags;
+    uint8_t     _precision;
+
+    uint8_t _buf[3 + 255];
+    size_t  _len;
+    bool    _empty;  // The frame has no fields yet
+    bool    _sent = false;
+
+    void begin() {
+        _len   = 3;
+        _empty = true;
+        u16(_flags);
+        str(_state, 8);
+        u8(_precision);
+        u8(Axes::_numberAxis);
+    }
+    void send() {
+        _buf[0] = 0x02;
+        _buf[1] = 'S';
+        _buf[2] = _len - 3;
+        LogStream msg(_channel, MsgLevelNone);
+        msg.write(_buf, _len);
+        _sent = true;
+    }
+
+public:
+    StatusFrame(Channel& channel, const char* state, bool mpos, int precision) :
+        _channel(channel), _state(state), _flags(mpos ? StatusMpos : 0), _precision(precision) {
+        begin();
+    }
+
+    // Makes room for a field of size bytes
+    void field(StatusField f, size_t size) {
+        if (!_empty && _len + size > sizeof(_buf)) {
+            send();
+            begin();
+        }
+        _empty = false;
+        _buf[3] |= uint8_t(f);
+        _buf[4] |= uint8_t(f >> 8);
+    }
+    void u8(uint8_t v) { _buf[_len++] = v; }
+    void u16(uint16_t v) {
+        u8(v);
+        u8(v >> 8);
+    }
+    void u32(uint32_t v) {
+        u16(v);
+        u16(v >> 16);
+    }
+    void str(const char* s, size_t maxlen) {
+        size_t len = std::min(strlen(s), maxlen);
+        u8(len);
+        while (len--) {
+            u8(*s++);
+        }
+    }
+    void axes(const float* values, int precision) {
+        auto n_axis = Axes::_numberAxis;
+        for (size_t axis = 0; axis < n_axis; axis++) {
+            u32(report_axis_units(axis, values[axis], precision));
+        }
+    }
+    // Sends the last frame, or the only one, even if it has no fields
+    void finish() {
+        if (!_empty || !_sent) {
+            send();
+        }
+    }
+};
+
+// Binary frames send positions as i32, so the decimals are reduced until
+// the largest position or offset fits, with a margin for rounding.
+static int report_binary_precision(const StatusValues& values, int precision) {
+    auto  n_axis  = Axes::_numberAxis;
+    float largest = 0;
+    for (size_t axis = 0; axis < n_axis; axis++) {
+        int decimals;
+        largest = std::max(largest, fabsf(report_axis_value(axis, values.pos[axis], precision, decimals)));
+        largest = std::max(largest, fabsf(report_axis_value(axis, values.wco[axis], precision, decimals)));
+    }
+    while (precision > 0 && largest * report_powers_of_10[precision] > 2e9f) {
+        --precision;
+    }
+    return precision;
+}
+
+static void report_status_binary(Channel& channel, const StatusValues& values, uint16_t fields) {
+    int precision = channel.reportOptions().precision;
+    if (precision < 0) {
+        precision = config->_reportInches ? 4 : 3;
+    }
+    precision = report_binary_precision(values, precision);
+
+    const size_t axes_size = Axes::_numberAxis * sizeof(int32_t);
+    const size_t max_job   = 120;
+
+    StatusFrame frame(channel, values.state, values.mpos, precision);
+    if (fields & StatusPos) {
+        frame.field(StatusPos, axes_size);
+        frame.axes(values.pos, precision);
+    }
+    if (fields & StatusBf) {
+        frame.field(StatusBf, 4);
+        frame.u16(values.planner_available);
+        frame.u16(channel.rx_buffer_available());
+    }
+    if (fields & StatusLn) {
+        frame.field(StatusLn, 4);
+        frame.u32(values.line_number);
+    }
+    if (fields & StatusFS) {
+        frame.field(StatusFS, 8);
+        frame.u32(lroundf(values.feed_rate));
+        frame.u32(values.spindle_speed);
+    }
+    if (fields & StatusPn) {
+        frame.field(StatusPn, 1 + strlen(values.pins));
+        frame.str(values.pins, sizeof(values.pins));
+    }
+    if (fields & StatusWCO) {
+        frame.field(StatusWCO, axes_size);
+        frame.axes(values.wco, precision);
+    }
+    if (fields & StatusOv) {
+        frame.field(StatusOv, 4);
+        frame.u8(values.overrides[0]);
+        frame.u8(values.overrides[1]);
+        frame.u8(values.overrides[2]);
+        frame.u8(values.accessories);
+    }
+    if (fields & StatusJob) {
+        const char* progress = Job::active() ? Job::channel()->_progress.c_str() : "";
+        frame.field(StatusJob, 1 + std::min(strlen(progress), max_job));
+        frame.str(progress, max_job);
+    }
+    frame.finish();
+}
+
+static void report_status(Channel& channel, const StatusValues& values, bool complete) {
+    const ReportOptions& options = channel.reportOptions();
+
+    uint16_t fields = options.fields;
+    switch (options.mode) {
+        case ReportMode::Full:
+            fields &= ~(StatusWCO | StatusOv) | report_periodic_fields();
+            report_status_text(channel, values, fields, false);
+            break;
+        case ReportMode::Delta:
+        case ReportMode::Binary: {
+            const StatusValues* last = channel.lastStatus();
+            if (!complete && last) {
+                fields = report_changed_fields(values, *last, fields, options.precision);
+            }
+            if (options.mode == ReportMode::Binary) {
+                report_status_binary(channel, values, fields);
+            } else {
+                report_status_text(channel, values, fields, !complete && last);
+            }
+            channel.setLastStatus(values);
+        } break;
+    }
+}
+
+// Prints real-time data. This function grabs a real-time snapshot of the stepper subprogram
+// and the actual location of the CNC machine. Users may change the following function to their
+// specific needs, but the desired real-time data report must be as short as possible. This is
+// requires as it minimizes the computational overhead to keep running smoothly,
+// especially during g-code programs with fast, short line segments and high frequency reports (5-20Hz).
+// A '?' request always gets a complete report in the channel's chosen format and fields.
+void report_realtime_status(Channel& channel) {
+    StatusValues values;
+    StatusSnapshot::read(values);
+    report_status(channel, values, true);
+}
+
+// Sends the automatic reports that are due in one scheduler tick.  Like
+// report_realtime_status(), but in Delta and Binary report modes, only the
+// fields that changed since the last report to the channel are sent.
+// Full mode channels with the same fields, precision and Bf: value share
+// one formatted report, and the WCO and Ov refresh counters advance once
+// per tick rather than once per channel.  The entries for channels that
+// got a shared report are set to nullptr.
+void report_realtime_updates(Channel** channels, size_t count, const StatusValues& values) {
+    uint16_t periodic = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        if (!channels[i]) {
+            continue;
+        }
+        Channel&             channel = *channels[i];
+        const ReportOptions& options = channel.reportOptions();
+        if (options.mode != ReportMode::Full) {
+            report_status(channel, values, false);
+            continue;
+        }
+        if (!periodic) {
+            periodic = ~(StatusWCO | StatusOv) | report_periodic_fields();
+        }
+        uint16_t fields = options.fields & periodic;
+        int      rx     = channel.rx_buffer_available();
+
+        StatusLine line;
+        report_status_text(line, values, fields, options.precision, rx, false);
+        line.send(channel);
+
+        for (size_t j = i + 1; j < count; ++j) {
+            if (!channels[j]) {
+                continue;
+            }
+            Channel&             other = *channels[j];
+            const ReportOptions& opts  = other.reportOptions();
+            if (opts.mode == ReportMode::Full && opts.fields == options.fields && opts.precision == options.precision &&
+                (!(fields & StatusBf) || other.rx_buffer_available() == rx)) {
+                line.send(other);
+                channels[j] = nullptr;
+            }
+        }
+    }
+}
+
 void hex_msg(uint8_t* buf, const char* prefix, int len) {
     char report[200];
     char temp[20];
@@ -63,6 +63,8 @@ void report_echo_line_received(char* line, Channel& channel);
 
 // Prints realtime status report
 void report_realtime_status(Channel& channel);
+void report_realtime_updates(Channel** channels, size_t count, const StatusValues& values);
+void report_capture_status(StatusValues& values);
 
 // Prints recorded probe position
 void report_probe_parameters(Channel& channel);
@@ -97,5 +99,3 @@ extern const char* git_url;
 
 extern bool readyNext;
 
-extern std::string report_pin_string;
-void               report_recompute_pin_string();
@@ -47,6 +47,7 @@
 #include "InputFile.h"
 #include "Main.h"        // display()
 #include "StartupLog.h"  // startupLog
+#include "StatusSnapshot.h"
 
 #include "Driver/fluidnc_gpio.h"
 
@@ -175,6 +176,115 @@ void AllChannels::print_msg(MsgLevel level, const char* msg) {
     _mutex_general.unlock();
 }
 
+// Every channel writes directly from the same line buffer, so
+// a broadcast costs no copies regardless of how many clients
+// are connected.
+void AllChannels::print_line(MsgLevel level, const char* line, size_t len) {
+    _mutex_general.lock();
+    for (auto channel : _channelq) {
+        channel->print_line(level, line, len);
+    }
+    _mutex_general.unlock();
+}
+
+static bool motionState() {
+    return state_is(State::Cycle) || state_is(State::Homing) || state_is(State::Jog);
+}
+
+// The modal state is compared once per tick for all channels, and the
+// channels are notified if a $G report is needed.
+bool AllChannels::gcodeStateChanged() {
+    // When moving, we suppress $G reports in which the only change is the motion mode
+    // (e.g. G0/G1/G2/G3 changes) because rapid-fire motion mode changes are fairly common.
+    // We would rather not issue a $G report after every GCode line.
+    // Similarly, F and S values can change rapidly, especially in laser programs.
+    // F and S values are also reported in ? status reports, so they will show up
+    // at the chosen periodic rate there.
+    if (motionState()) {
+        // Force the compare to succeed if the only change is the motion mode
+        _lastModal.motion = gc_state.modal.motion;
+    }
+    if (memcmp(&_lastModal, &gc_state.modal, sizeof(_lastModal)) || _lastTool != gc_state.selected_tool ||
+        (!motionState() && (_lastSpindleSpeed != gc_state.spindle_speed || _lastFeedRate != gc_state.feed_rate))) {
+        memcpy(&_lastModal, &gc_state.modal, sizeof(_lastModal));
+        _lastTool         = gc_state.selected_tool;
+        _lastSpindleSpeed = gc_state.spindle_speed;
+        _lastFeedRate     = gc_state.feed_rate;
+        return true;
+    }
+    return false;
+}
+
+// Automatic reports are driven from the polling loop on a schedule of
+// their own, rather than from each channel's pollLine(), so the report
+// cadence does not depend on how much input the channels are receiving.
+// Each tick captures one status snapshot and offers it to every channel.
+// Channels whose reports are due in the same tick get them together,
+// and those with identical report options share the formatted text.
+void AllChannels::dispatchReports() {
+    int32_t now = int32_t(xTaskGetTickCount());
+    if ((now - _nextReportTick) < 0) {
+        return;
+    }
+
+    bool gcodeChanged = gcodeStateChanged();
+
+    // The reports are sent after releasing the mutex, because sending
+    // can block until the output task - which also takes the mutex for
+    // broadcast messages - makes room in the message queue.  Channels
+    // are only deleted by poll(), which runs in this same task, so the
+    // pointers remain valid.  The lists keep their capacity from tick to
+    // tick, so they allocate only when a channel is added.
+    _reporters.clear();
+    _due.clear();
+
+    _mutex_general.lock();
+    for (auto channel : _channelq) {
+        if (gcodeChanged) {
+            channel->notifyGCodeState();
+        }
+        if (channel->getReportInterval()) {
+            _reporters.push_back(channel);
+        }
+    }
+    _mutex_general.unlock();
+
+    // Nothing is captured unless some channel takes reports
+    int32_t next = now + report_tick_ms;
+    if (_reporters.empty()) {
+        _nextReportTick = next;
+        return;
+    }
+    StatusValues values;
+    StatusSnapshot::read(values);
+
+    // Sample for changes every tick, but wake up early for a periodic
+    // deadline that comes sooner, so periodic reports are not delayed
+    // by up to a tick.
+    for (auto& channel : _reporters) {
+        if (!channel->canAutoReport()) {
+            channel = nullptr;
+            continue;
+        }
+        if (channel->statusReportDue(values, now)) {
+            _due.push_back(channel);
+        }
+        int32_t deadline = channel->reportDeadline();
+        if ((deadline - now) > 0 && (deadline - next) < 0) {
+            next = deadline;
+        }
+    }
+    _nextReportTick = next;
+
+    report_realtime_updates(_due.data(), _due.size(), values);
+
+    for (auto channel : _reporters) {
+        if (channel) {
+            channel->autoReport(values);
+        }
+    }
+}
+
 Channel* AllChannels::find(const std::string& name) {
     _mutex_general.lock();
     for (auto channel : _channelq) {
@@ -29,6 +29,20 @@ class AllChannels : public Channel {
     Channel*     _lastChannel = nullptr;
     xQueueHandle _killQueue;
 
+    // Automatic report scheduling
+    static constexpr int report_tick_ms = 10;  // Sampling period for changes
+
+    std::vector<Channel*> _reporters;  // Channels with automatic reports
+    std::vector<Channel*> _due;        // Those with a status report due
+
+    int32_t    _nextReportTick   = 0;
+    gc_modal_t _lastModal        = modal_defaults;
+    uint8_t    _lastTool         = 0;
+    float      _lastSpindleSpeed = 0;
+    float      _lastFeedRate     = 0;
+
+    bool gcodeStateChanged();
+
     static std::mutex _mutex_general;
     static std::mutex _mutex_pollLine;
 
@@ -46,6 +60,7 @@ public:
     size_t write(const uint8_t* buffer, size_t length) override;
 
     void print_msg(MsgLevel level, const char* msg) override;
+    void print_line(MsgLevel level, const char* line, size_t len) override;
 
     void flushRx();
 
@@ -53,6 +68,8 @@ public:
     void notifyWco();
     void notifyNgc(CoordIndex coord);
 
+    void dispatchReports();
+
     void listChannels(Channel& out);
 
     Channel* find(const std::string& name);
@@ -2,7 +2,9 @@
 
 #include "System.h"    // sys
 #include "Protocol.h"  // protocol_buffer_synchronize
+#include "Planner.h"   // plan_get_current_block
 #include "Machine/MachineConfig.h"
+#include "FluidPath.h"
 
 #include <map>
 #include <limits>
@@ -10,6 +12,7 @@
 #include <vector>
 #include <charconv>
 #include <nvs.h>
+#include <cstdio>
 
 std::vector<Setting*> Setting::List __attribute__((init_priority(101))) = {};
 std::vector<Command*> Command::List __attribute__((init_priority(102))) = {};
@@ -55,6 +58,19 @@ bool allowConfigStates() {
     return !state_is(State::Idle) && !state_is(State::Alarm) && !state_is(State::ConfigAlarm) && !state_is(State::Critical);
 }
 
+// FNV-1a, ignoring case
+uint32_t word_hash(const char* name) {
+    uint32_t hash = 2166136261u;
+    for (; *name; ++name) {
+        char c = *name;
+        if (c >= 'A' && c <= 'Z') {
+            c += 'a' - 'A';
+        }
+        hash = (hash ^ uint8_t(c)) * 16777619u;
+    }
+    return hash;
+}
+
 Word::Word(type_t type, permissions_t permissions, const char* description, const char* grblName, const char* fullName) :
     _description(description), _grblName(grblName), _fullName(fullName), _type(type), _permissions(permissions) {}
 
@@ -420,6 +436,66 @@ Error UserCommand::action(const char* value, AuthenticationLevel auth_level, Cha
 };
 Coordinates* coords[CoordIndex::End];
 
+// Coordinate systems that have changed since they were written to NVS
+// are journaled in a file on the local filesystem, a record per change,
+// so the change survives a power cut even while motion is planned.
+// Appending a record is a short flash write, unlike an NVS write that
+// can stall while NVS erases a page.  flush() writes the changes to NVS
+// and then deletes the journal.
+struct CoordRecord {
+    uint32_t index;
+    float    values[MAX_N_AXIS];
+};
+static const char* journal_name = ".coords";
+static uint32_t    pending;  // Bit mask by CoordIndex
+
+static bool journal_append(CoordIndex index, const float* values) {
+    std::error_code ec;
+    FluidPath       fpath { journal_name, "", ec };
+    if (ec) {
+        return false;
+    }
+    FILE* fd = fopen(fpath.c_str(), "ab");
+    if (!fd) {
+        return false;
+    }
+    CoordRecord record = { index };
+    memcpy(record.values, values, sizeof(record.values));
+    bool ok = fwrite(&record, sizeof(record), 1, fd) == 1;
+    return fclose(fd) == 0 && ok;
+}
+
+static void journal_remove() {
+    std::error_code ec;
+    FluidPath       fpath { journal_name, "", ec };
+    if (!ec) {
+        stdfs::remove(fpath, ec);
+    }
+}
+
+void Coordinates::replay_journal() {
+    std::error_code ec;
+    FluidPath       fpath { journal_name, "", ec };
+    FILE*           fd;
+    if (ec || !(fd = fopen(fpath.c_str(), "rb"))) {
+        return;
+    }
+    // A record cut short by a power failure is ignored
+    CoordRecord record;
+    while (fread(&record, sizeof(record), 1, fd) == 1) {
+        if (record.index < CoordIndex::End && coords[record.index]) {
+            auto coord = coords[record.index];
+            memcpy(coord->_currentValue, record.values, sizeof(coord->_currentValue));
+            coord->_dirty = true;
+            set_bitnum(pending, record.index);
+        }
+    }
+    fclose(fd);
+    if (pending) {
+        log_info("Restored coordinate changes that were not saved");
+    }
+}
+
 bool Coordinates::load() {
     size_t len;
     switch (nvs_get_blob(Setting::_handle, _name, _currentValue, &len)) {
@@ -442,10 +518,41 @@ bool Coordinates::load() {
 
 void Coordinates::set(float value[MAX_N_AXIS]) {
     memcpy(&_currentValue, value, sizeof(_currentValue));
-    if (FORCE_BUFFER_SYNC_DURING_NVS_WRITE) {
-        protocol_buffer_synchronize();
+    // Before the local filesystem is mounted, as when the defaults are set
+    // at startup, the change is kept in RAM until flush()
+    journal_append(_index, _currentValue);
+    set_bitnum(pending, _index);
+    _dirty = true;
+}
+
+bool Coordinates::save() {
+    if (nvs_set_blob(Setting::_handle, _name, _currentValue, sizeof(_currentValue))) {
+        return false;
+    }
+    clear_bitnum(pending, _index);
+    _dirty = false;
+    return true;
+}
+
+void Coordinates::flush(bool force) {
+    if (!pending) {
+        return;
+    }
+    // Flash writes stall the CPU, so wait until no motion is planned
+    if (!force && FORCE_BUFFER_SYNC_DURING_NVS_WRITE &&
+        (!(state_is(State::Idle) || state_is(State::Alarm)) || plan_get_current_block())) {
+        return;
+    }
+    for (auto coord : coords) {
+        if (coord && coord->_dirty && !coord->save()) {
+            log_error("Cannot save coordinates " << coord->_name);
+        }
+    }
+    nvs_commit(Setting::_handle);
+    if (!pending) {
+        // Everything in the journal is now in NVS
+        journal_remove();
     }
-    nvs_set_blob(Setting::_handle, _name, _currentValue, sizeof(_currentValue));
 }
 
 IPaddrSetting::IPaddrSetting(
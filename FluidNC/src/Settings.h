@@ -6,7 +6,11 @@
 #include "src/GCode.h"   // CoordIndex
 
 #include <string_view>
+#include <atomic>
 #include <map>
+#include <vector>
+#include <cstring>
+#include <strings.h>  // strcasecmp
 #include <nvs.h>
 #include <string_view>
 
@@ -81,6 +85,91 @@ public:
     const char*   getDescription() { return _description; }
 };
 
+// Case-insensitive hash of a word name
+uint32_t word_hash(const char* name);
+
+// WordIndex finds words in Command::List or Setting::List by name without
+// scanning the list.  It indexes the full names, the grbl names, or both.
+// Like a scan of the list, a lookup returns the first word in the list that
+// has the name.
+//
+// Commands are looked up from the protocol loop and from the web server
+// task, so the index is built just once, at the end of startup, and is
+// never changed afterwards.  Until then, or if the list has grown since,
+// find() scans the list instead.
+template <class T>
+class WordIndex {
+    struct Slot {
+        const char* name;
+        T*          word;
+        uint32_t    hash;
+    };
+    std::vector<Slot>   _slots;
+    std::atomic<size_t> _indexed { 0 };  // The list size when the index was built
+    bool                _full_names;
+    bool                _grbl_names;
+
+    void insert(T* word, const char* name) {
+        uint32_t hash = word_hash(name);
+        size_t   mask = _slots.size() - 1;
+        size_t   i    = hash & mask;
+        for (; _slots[i].word; i = (i + 1) & mask) {
+            if (_slots[i].hash == hash && strcasecmp(_slots[i].name, name) == 0) {
+                return;  // An earlier word has the name
+            }
+        }
+        _slots[i] = { name, word, hash };
+    }
+
+    bool matches(T* word, const char* name) {
+        return (_full_names && strcasecmp(word->getName(), name) == 0) ||
+               (_grbl_names && word->getGrblName() && strcasecmp(word->getGrblName(), name) == 0);
+    }
+
+public:
+    WordIndex(bool full_names, bool grbl_names) : _full_names(full_names), _grbl_names(grbl_names) {}
+
+    void build(const std::vector<T*>& list) {
+        if (_indexed) {
+            return;  // Lookups may already be using it
+        }
+        // Each word can have two names, and the table is kept at most half full
+        size_t size = 16;
+        while (size < list.size() * 4) {
+            size *= 2;
+        }
+        _slots.assign(size, Slot { nullptr, nullptr, 0 });
+        for (T* word : list) {
+            if (_full_names) {
+                insert(word, word->getName());
+            }
+            if (_grbl_names && word->getGrblName()) {
+                insert(word, word->getGrblName());
+            }
+        }
+        _indexed.store(list.size(), std::memory_order_release);
+    }
+
+    T* find(const std::vector<T*>& list, const char* name) {
+        if (_indexed.load(std::memory_order_acquire) != list.size()) {
+            for (T* word : list) {
+                if (matches(word, name)) {
+                    return word;
+                }
+            }
+            return nullptr;
+        }
+        uint32_t hash = word_hash(name);
+        size_t   mask = _slots.size() - 1;
+        for (size_t i = hash & mask; _slots[i].word; i = (i + 1) & mask) {
+            if (_slots[i].hash == hash && strcasecmp(_slots[i].name, name) == 0) {
+                return _slots[i].word;
+            }
+        }
+        return nullptr;
+    }
+};
+
 class Command : public Word {
 private:
     bool _synchronous = true;
@@ -249,13 +338,23 @@ public:
     const char* getDefaultString() override { return ""; }
 };
 
+// Changes to coordinate systems are kept in RAM and written to NVS by
+// flush() at the first point where no motion is planned, or before the
+// next cycle starts, so G10 and G28.1/G30.1 do not stall the planner on
+// NVS writes.  Until then they are journaled in a file on the local
+// filesystem, which replay_journal() reads back after a reset or a
+// power cut.
 class Coordinates {
 private:
     float       _currentValue[MAX_N_AXIS];
     const char* _name;
+    CoordIndex  _index;
+    bool        _dirty = false;
+
+    bool save();
 
 public:
-    Coordinates(const char* name) : _name(name) {}
+    Coordinates(const char* name, CoordIndex index) : _name(name), _index(index) {}
 
     const char* getName() { return _name; }
     bool        load();
@@ -276,6 +375,15 @@ public:
     void set(int axis, float value) { _currentValue[axis] = value; }
 
     void set(float* value);
+
+    // Writes the changed coordinate systems to NVS.  Unless force is
+    // true, that waits until the machine is idle with an empty planner.
+    // Called from the protocol loop and before a cycle starts.
+    static void flush(bool force = false);
+
+    // Applies the changes in the journal that were not flushed before a
+    // reset.  Called once the local filesystem is mounted.
+    static void replay_journal();
 };
 
 extern Coordinates* coords[CoordIndex::End];
@@ -37,7 +37,7 @@ EnumSetting* gcode_echo;
 
 void make_coordinate(CoordIndex index, const char* name) {
     float coord_data[MAX_N_AXIS] = { 0.0 };
-    auto  coord                  = new Coordinates(name);
+    auto  coord                  = new Coordinates(name, index);
     coords[index]                = coord;
     if (!coord->load()) {
         coords[index]->setDefault();
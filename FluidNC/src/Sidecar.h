@@ -0,0 +1,74 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// The sidecar of dir/name is the hidden file dir/.name.pre.  It starts
+// with a header, followed by a record for each line:
+//   uint32_t line_number;
+//   uint16_t length;
+//   char     text[length];  // Not NUL-terminated
+//
+// The size and modification time of the GCode file tell whether the
+// sidecar is still valid, without reading the GCode file.  Files written
+// by the firmware, whose times do not change because it has no clock,
+// lose their sidecars through discard_preprocessed().  On the local
+// filesystem the HashFS digest, which costs nothing to look up, is
+// checked as well.
+
+#include "Error.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+struct SidecarHeader {
+    char     magic[4];
+    uint16_t version;
+    uint16_t collapse_version;  // GCodeLexer::collapse_version
+    uint32_t source_size;
+    uint32_t records;
+    int64_t  source_mtime;
+    char     hash[68];  // HashFS::hash() of a local GCode file, NUL-padded
+};
+
+static const char     sidecar_magic[4] = { 'F', 'N', 'C', 'P' };
+static const uint16_t sidecar_version  = 2;
+
+template <typename F>
+void write_sidecar_record(F& out, uint32_t line_number, const char* line) {
+    uint16_t length = strlen(line);
+    out.write((uint8_t*)&line_number, sizeof(line_number));
+    out.write((uint8_t*)&length, sizeof(length));
+    out.write((uint8_t*)line, length);
+}
+
+// Reads the records of a sidecar that is open in a FileStream-like F.
+// Positions are counted from the first record, so position 0 is the
+// start of the program, as it is when reading the GCode text.  A job
+// that rewinds to look for subroutines thus lands on the first record
+// rather than in the header.
+template <typename F>
+class SidecarReader {
+    F& _file;
+
+public:
+    explicit SidecarReader(F& file) : _file(file) {}
+
+    size_t position() { return _file.position() - sizeof(SidecarHeader); }
+    void   set_position(size_t pos) { _file.set_position(pos + sizeof(SidecarHeader)); }
+    size_t size() { return _file.size() - sizeof(SidecarHeader); }
+
+    Error read(char* line, int maxlen, uint32_t& line_number) {
+        uint16_t length;
+        if (_file.read((uint8_t*)&line_number, sizeof(line_number)) != sizeof(line_number)) {
+            return Error::Eof;
+        }
+        if (_file.read((uint8_t*)&length, sizeof(length)) != sizeof(length) || length >= maxlen ||
+            _file.read((uint8_t*)line, length) != length) {
+            return Error::FsFailedRead;
+        }
+        line[length] = '\0';
+        return Error::Ok;
+    }
+};
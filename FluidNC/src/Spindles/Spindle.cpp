@@ -26,6 +26,7 @@ namespace Spindles {
         }
         if (!_m6_macro._gcode.empty()) {
             _atc_info = " with m6_macro";
+            _m6_macro.prefetch();
         }
     }
 
@@ -16,6 +16,14 @@ public:
 
     static void init();
     static void dump(Channel& channel);
+
+    // stage() ends the boot stage called name and starts the next one.
+    // The stage times are kept with the log, so a boot that hangs or is
+    // reset by the watchdog still shows how far it got.
+    static void stage(const char* name);
+
+    // finish() marks the boot complete and logs the stage times
+    static void finish();
 };
 
 extern StartupLog startupLog;
@@ -0,0 +1,101 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// Types for per-channel control of realtime status reports.
+//
+// The classic report <State|MPos:...|Bf:...|FS:...|...> is rebuilt in full
+// for every '?' and every auto-report tick.  A channel can instead negotiate:
+//
+// - $Report/Fields - which fields it wants, e.g. "Pos,FS,Ov" or "all"
+// - $Report/Precision - how many decimals positions and offsets are sent with
+// - $Report/Mode - Full, Delta or Binary
+//
+// In Delta mode, automatic reports contain the state plus only the fields
+// whose values changed since the previous report to that channel.  A '?'
+// always elicits a complete report so a client can resynchronize.  In a
+// delta text report, an empty Pn: or A: field means the value was cleared,
+// Ln:0 means there is no line number, and an empty SD: field means the job
+// has ended.
+//
+// Binary mode is delta-encoded like Delta mode, but each report is a frame:
+//
+//   0x02 'S' <payload length:u8> <payload> '\n'
+//
+// where the payload is, with little-endian multibyte values:
+//
+//   u16   mask of the StatusField values that are present, plus StatusMpos
+//   u8    state name length, followed by the state name, e.g. "Hold:0"
+//   i8    decimals - positions are integers in units of 10^-decimals.  It
+//         can be less than $Report/Precision if a position would not fit.
+//   u8    number of axes
+//   Pos:  i32 per axis
+//   Bf:   u16 planner blocks available, u16 rx bytes available
+//   Ln:   u32 line number
+//   FS:   i32 feed rate, u32 spindle speed
+//   Pn:   u8 length, followed by pin letters
+//   WCO:  i32 per axis
+//   Ov:   u8 feed, u8 rapid, u8 spindle override, u8 StatusAccessory mask
+//   Job:  u8 length, followed by the job progress text, empty when the job ends
+//
+// A report whose fields do not fit in one frame is sent as several frames,
+// each with the header and some of the fields.
+
+#include "Config.h"  // MAX_N_AXIS
+
+#include <cstdint>
+
+enum StatusField : uint16_t {
+    StatusPos = bitnum_to_mask(0),  // MPos: or WPos:
+    StatusBf  = bitnum_to_mask(1),  // Bf:
+    StatusLn  = bitnum_to_mask(2),  // Ln:
+    StatusFS  = bitnum_to_mask(3),  // FS:
+    StatusPn  = bitnum_to_mask(4),  // Pn:
+    StatusWCO = bitnum_to_mask(5),  // WCO:
+    StatusOv  = bitnum_to_mask(6),  // Ov: and A:
+    StatusJob = bitnum_to_mask(7),  // SD: or macro progress
+
+    // In binary frames only - Pos is machine position instead of work position
+    StatusMpos = bitnum_to_mask(15),
+};
+
+const uint16_t AllStatusFields = 0xff;
+
+enum StatusAccessory : uint8_t {
+    AccessorySpindleCw  = bitnum_to_mask(0),
+    AccessorySpindleCcw = bitnum_to_mask(1),
+    AccessoryFlood      = bitnum_to_mask(2),
+    AccessoryMist       = bitnum_to_mask(3),
+};
+
+enum class ReportMode : uint8_t {
+    Full,
+    Delta,
+    Binary,
+};
+
+struct ReportOptions {
+    uint16_t   fields    = AllStatusFields;
+    ReportMode mode      = ReportMode::Full;
+    int8_t     precision = -1;  // -1 means 3 decimals for mm and 4 for inches
+};
+
+// The machine values that a status report is formatted from.  They are
+// captured once per report and then formatted for the channel according
+// to its ReportOptions.  Each channel keeps a copy of the values it was
+// last sent, which Delta and Binary modes compare against.
+struct StatusValues {
+    const char* state;
+    bool        mpos;  // pos[] is machine position, else work position
+    float       pos[MAX_N_AXIS];
+    int         planner_available;
+    uint32_t    line_number;
+    float       feed_rate;
+    uint32_t    spindle_speed;
+    char        pins[MAX_N_AXIS * 2 + 12];
+    float       wco[MAX_N_AXIS];
+    uint8_t     overrides[3];  // feed, rapid, spindle
+    uint8_t     accessories;   // StatusAccessory bits
+    uint32_t    job_hash;      // Hash of the job progress text, 0 if no job
+};
@@ -0,0 +1,61 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "StatusSnapshot.h"
+
+#include "Report.h"  // report_capture_status()
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+StatusValues          StatusSnapshot::_values;
+std::atomic<uint32_t> StatusSnapshot::_seq(0);
+std::atomic_flag      StatusSnapshot::_writing = ATOMIC_FLAG_INIT;
+std::atomic<bool>     StatusSnapshot::_captured(false);
+uint32_t              StatusSnapshot::_time = 0;
+
+void StatusSnapshot::update(uint32_t max_age_ms) {
+    uint32_t now = xTaskGetTickCount();
+    if (max_age_ms && _captured.load() && (now - _time) < (max_age_ms / portTICK_PERIOD_MS)) {
+        return;
+    }
+    if (_writing.test_and_set(std::memory_order_acquire)) {
+        return;
+    }
+
+    // Capture into a local copy so the write window, during which readers
+    // must retry, is only as long as a memcpy.
+    StatusValues values;
+    report_capture_status(values);
+
+    _seq.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    _values = values;
+    _time   = now;
+    _seq.fetch_add(1, std::memory_order_release);
+    _captured.store(true, std::memory_order_release);
+
+    _writing.clear(std::memory_order_release);
+}
+
+void StatusSnapshot::read(StatusValues& values, uint32_t max_age_ms) {
+    update(max_age_ms);
+    int      spins = 0;
+    uint32_t seq;
+    while (true) {
+        // Until the first capture is done, there is nothing to copy
+        seq = _seq.load(std::memory_order_acquire);
+        if (_captured.load(std::memory_order_acquire) && !(seq & 1)) {
+            values = _values;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq == _seq.load(std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        // If the writer is a lower priority task on this core, it cannot
+        // finish until we get out of its way.
+        if (++spins > 100) {
+            vTaskDelay(1);
+        }
+    }
+}
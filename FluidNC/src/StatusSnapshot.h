@@ -0,0 +1,46 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#pragma once
+
+// StatusSnapshot is the one shared copy of the machine status that status
+// reports, the OLED display, the status output pins and the WebUI channels
+// all read from.  It is captured on demand: a reader that finds it older
+// than refresh_ms captures new values first, so nothing is captured while
+// nobody is reading, and the stepper position, overrides, pin states and
+// so on are captured once per refresh instead of being recomputed - and
+// for the OLED and status outputs, re-parsed from report text - by every
+// consumer.
+//
+// The snapshot is protected by a sequence lock.  The writer makes the
+// sequence number odd while it copies new values in, and readers retry
+// if the sequence number was odd or changed during their copy, so
+// neither side ever blocks the other.
+
+#include "StatusReport.h"  // StatusValues
+
+#include <atomic>
+#include <cstdint>
+
+class StatusSnapshot {
+    static StatusValues          _values;
+    static std::atomic<uint32_t> _seq;
+    static std::atomic_flag      _writing;
+    static std::atomic<bool>     _captured;  // Separate from _seq, which wraps around to 0
+    static uint32_t              _time;  // Tick count when _values was captured
+
+public:
+    // How old the snapshot may be before a reader refreshes it
+    static const uint32_t refresh_ms = 10;
+
+    // update() captures new values if the snapshot is older than max_age_ms.
+    // If another task is updating the snapshot at the same time, it returns
+    // without waiting, since the other task's values are just as fresh.
+    static void update(uint32_t max_age_ms = 0);
+
+    // read() refreshes the snapshot if it is older than max_age_ms, then copies it
+    static void read(StatusValues& values, uint32_t max_age_ms = refresh_ms);
+
+    // The sequence number changes each time the snapshot is updated
+    static uint32_t sequence() { return _seq.load(); }
+};
@@ -39,47 +39,30 @@ void Status_Outputs::init() {
     setReportInterval(_report_interval_ms);
 }
 
-void Status_Outputs::parse_report() {
-    if (_report.rfind("<", 0) == 0) {
-        parse_status_report();
-        return;
-    }
-}
-
-// This is how the OLED driver receives channel data
+// Status report text is not needed since the state is read directly
+// from the shared status snapshot.
 size_t Status_Outputs::write(uint8_t data) {
-    char c = data;
-    if (c == '\r') {
-        return 1;
-    }
-    if (c == '\n') {
-        parse_report();
-        _report = "";
-        return 1;
-    }
-    _report += c;
     return 1;
 }
 
-Error Status_Outputs::pollLine(char* line) {
-    autoReport();
-    return Error::NoData;
+void Status_Outputs::autoReport(const StatusValues& values) {
+    if (!_reportInterval || int32_t(xTaskGetTickCount() - _nextReportTime) < 0) {
+        return;
+    }
+    _nextReportTime = xTaskGetTickCount() + _reportInterval;
+    if (values.state != _state) {
+        show_state(values.state);
+    }
 }
 
-void Status_Outputs::parse_status_report() {
-    if (_report.back() == '>') {
-        _report.pop_back();
-    }
-    // Now the string is a sequence of field|field|field
-    size_t pos     = 0;
-    auto   nextpos = _report.find_first_of("|", pos);
-    _state         = _report.substr(pos + 1, nextpos - pos - 1);
+void Status_Outputs::show_state(const char* state) {
+    _state = state;
 
-    _Idle_pin.write(_state == "Idle");
-    _Run_pin.write(_state == "Run");
-    _Hold_pin.write(_state.substr(0, 4) == "Hold");
-    _Alarm_pin.write(_state == "Alarm");
-    _Door_pin.write(_state.substr(0,4) == "Door");
+    _Idle_pin.write(strcmp(state, "Idle") == 0);
+    _Run_pin.write(strcmp(state, "Run") == 0);
+    _Hold_pin.write(strncmp(state, "Hold", 4) == 0);
+    _Alarm_pin.write(strcmp(state, "Alarm") == 0);
+    _Door_pin.write(strncmp(state, "Door", 4) == 0);
 }
 
 // Configuration registration
@@ -13,13 +13,11 @@ class Status_Outputs : public Channel, public ConfigurableModule {
 
 public:
 private:
-    std::string _report;
-    std::string _state;
+    const char* _state = nullptr;
 
     int _report_interval_ms = 500;
 
-    void parse_report();
-    void parse_status_report();
+    void show_state(const char* state);
 
 public:
     Status_Outputs(const char* name) : Channel(name), ConfigurableModule(name) {}
@@ -35,7 +33,9 @@ public:
 
     size_t write(uint8_t data) override;
 
-    Error pollLine(char* line) override;
+    Error pollLine(char* line) override { return Error::NoData; }
+    bool  statusReportDue(const StatusValues& values, int32_t now) override { return false; }
+    void  autoReport(const StatusValues& values) override;
     void  flushRx() override {}
 
     bool   lineComplete(char*, char) override { return false; }
@@ -87,21 +87,17 @@ namespace WebUI {
         return true;
     }
 
-    void WSChannel::autoReport() {
+    bool WSChannel::canAutoReport() {
         if (!_active) {
-            return;
+            return false;
         }
         int stat = _server->canSend(_clientNum);
         if (stat < 0) {
             _active = false;
             log_debug_to(Uart0, "WebSocket is dead; closing");
-            return;
-        }
-        if (stat == 0) {
-            return;
+            return false;
         }
-
-        Channel::autoReport();
+        return stat != 0;
     }
 
     WSChannel::~WSChannel() {}
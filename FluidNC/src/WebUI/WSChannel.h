@@ -41,7 +41,7 @@ namespace WebUI {
         int read() override;
         int available() override { return _queue.size() + (_rtchar > -1); }
 
-        void autoReport() override;
+        bool canAutoReport() override;
 
     private:
         WebSocketsServer* _server;
@@ -3,6 +3,7 @@
 
 #include "src/Report.h"
 #include "WebClient.h"
+#include "src/LogPool.h"
 #include <WebServer.h>
 
 namespace WebUI {
@@ -66,12 +67,19 @@ namespace WebUI {
         print_msg(level, line);
     }
     void WebClient::sendLine(MsgLevel level, const std::string* line) {
-        print_msg(level, line->c_str());
+        print_line(level, line->c_str(), line->length());
+        print_line(level, "\n", 1);
         delete line;
     }
     void WebClient::sendLine(MsgLevel level, const std::string& line) {
         print_msg(level, line.c_str());
     }
+    void WebClient::sendLine(MsgLevel level, LogBuffer* line) {
+        // The text can be a binary status frame, so it is sent by length
+        line->text[line->len++] = '\n';
+        print_line(level, line->text, line->len);
+        LogPool::release(line);
+    }
 
     void WebClient::out(const char* s, const char* tag) {
         write((uint8_t*)s, strlen(s));
@@ -677,9 +677,14 @@ namespace WebUI {
         }
 
         static bool ConnectSTA2AP() {
+            // The status is polled often so that startup continues as soon as
+            // the connection is made, but progress is shown every 2 seconds.
+            const size_t polls_per_message = 20;
+            const size_t poll_ms           = 100;
+
             std::string msg, msg_out;
             uint8_t     dot = 0;
-            for (size_t i = 0; i < 10; ++i) {
+            for (size_t i = 0; i < 10 * polls_per_message; ++i) {
                 switch (WiFi.status()) {
                     case WL_NO_SSID_AVAIL:
                         log_info("No SSID");
@@ -691,17 +696,19 @@ namespace WebUI {
                         log_info("Connected - IP is " << IP_string(WiFi.localIP()));
                         return true;
                     default:
-                        if ((dot > 3) || (dot == 0)) {
-                            dot     = 0;
-                            msg_out = "Connecting";
+                        if (i % polls_per_message == 0) {
+                            if ((dot > 3) || (dot == 0)) {
+                                dot     = 0;
+                                msg_out = "Connecting";
+                            }
+                            msg_out += ".";
+                            msg = msg_out;
+                            dot++;
+                            log_info(msg);
                         }
-                        msg_out += ".";
-                        msg = msg_out;
-                        dot++;
                         break;
                 }
-                log_info(msg);
-                delay_ms(2000);  // Give it some time to connect
+                delay_ms(poll_ms);  // Give it some time to connect
             }
             return false;
         }
@@ -15,6 +15,29 @@ namespace string_util {
         return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](auto a, auto b) { return tolower(a) == tolower(b); });
     }
 
+    // Configuration keys are matched against the names of many items, so
+    // these compare without measuring the NUL-terminated name first.  Most
+    // names differ from the key in the first character.
+    bool equal_ignore_case(std::string_view a, const char* b) {
+        for (char c : a) {
+            if (*b == '\0' || tolower(c) != tolower(*b)) {
+                return false;
+            }
+            ++b;
+        }
+        return *b == '\0';
+    }
+
+    // True if the first segment of a /-separated path is name, ignoring case
+    bool segment_is(const char* path, const char* name) {
+        for (; *name; ++name, ++path) {
+            if (tolower(*path) != tolower(*name)) {
+                return false;
+            }
+        }
+        return *path == '\0' || *path == '/';
+    }
+
     // cppcheck-suppress unusedFunction
     bool starts_with_ignore_case(std::string_view a, std::string_view b) {
         return std::equal(a.begin(), a.begin() + b.size(), b.begin(), b.end(), [](auto a, auto b) { return tolower(a) == tolower(b); });
@@ -6,6 +6,8 @@
 namespace string_util {
     char                   tolower(char c);
     bool                   equal_ignore_case(std::string_view a, std::string_view b);
+    bool                   equal_ignore_case(std::string_view a, const char* b);
+    bool                   segment_is(const char* path, const char* name);
     bool                   starts_with_ignore_case(std::string_view a, std::string_view b);
     const std::string_view trim(std::string_view s);
 
@@ -0,0 +1,130 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/string_util.h"
+#include "src/Configuration/Tokenizer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <strings.h>
+#include <vector>
+
+using namespace string_util;
+
+TEST(ConfigKey, EqualIgnoreCase) {
+    EXPECT_TRUE(equal_ignore_case(std::string_view("steps_per_mm"), "Steps_Per_MM"));
+    EXPECT_TRUE(equal_ignore_case(std::string_view(""), ""));
+    EXPECT_FALSE(equal_ignore_case(std::string_view("steps"), "steps_per_mm"));
+    EXPECT_FALSE(equal_ignore_case(std::string_view("steps_per_mm"), "steps"));
+    EXPECT_FALSE(equal_ignore_case(std::string_view("x"), "y"));
+    EXPECT_FALSE(equal_ignore_case(std::string_view(""), "x"));
+}
+
+TEST(ConfigKey, SegmentIs) {
+    EXPECT_TRUE(segment_is("axes/x/steps_per_mm", "Axes"));
+    EXPECT_TRUE(segment_is("steps_per_mm", "steps_per_mm"));
+    EXPECT_FALSE(segment_is("axes/x", "ax"));
+    EXPECT_FALSE(segment_is("ax", "axes"));
+    EXPECT_FALSE(segment_is("axesx/y", "axes"));
+}
+
+// The text of the example configurations
+static std::vector<std::string> example_configs() {
+    std::string              dir = __FILE__;
+    std::vector<std::string> configs;
+    dir = dir.substr(0, dir.rfind('/')) + "/../../example_configs/";
+    for (auto name : { "4x_2209_atc.yaml", "4x_2209_atc_class.yaml", "4x_2209a_atc_class.yaml", "uartio.yaml" }) {
+        std::ifstream file(dir + name);
+        if (file) {
+            std::stringstream s;
+            s << file.rdbuf();
+            configs.push_back(s.str());
+        }
+    }
+    return configs;
+}
+
+// The previous Parser::is()
+static bool legacy_is(std::string_view key, const char* expected) {
+    auto len = strlen(expected);
+    if (len != key.size()) {
+        return false;
+    }
+    return !strncasecmp(expected, key.data(), len);
+}
+
+using Matcher = bool (*)(std::string_view, const char*);
+
+// Tokenizes yaml with the real Tokenizer and matches each key against the
+// item names of its section until one matches, as ParserHandler does when
+// group() visits the items of a section.  With matcher null, it collects
+// the names of each section instead.  Returns the number of compares.
+static size_t walk(const std::string& yaml, std::map<std::string, std::vector<std::string>>& names, Matcher matcher) {
+    Configuration::Tokenizer                 tokenizer(yaml);
+    std::vector<std::pair<int, std::string>> sections;  // Indent and path of the enclosing tokens
+    size_t                                   compares = 0;
+    for (tokenizer.Tokenize(); tokenizer._token._state != Configuration::TokenState::Eof; tokenizer.Tokenize()) {
+        auto& token = tokenizer._token;
+        while (!sections.empty() && sections.back().first >= token._indent) {
+            sections.pop_back();
+        }
+        std::string parent = sections.empty() ? "" : sections.back().second;
+        auto&       items  = names[parent];
+        if (matcher) {
+            for (const auto& item : items) {
+                ++compares;
+                if (matcher(token._key, item.c_str())) {
+                    break;
+                }
+            }
+        } else if (std::find(items.begin(), items.end(), token._key) == items.end()) {
+            items.emplace_back(token._key);
+        }
+        sections.emplace_back(token._indent, parent + "/" + std::string(token._key));
+    }
+    return compares;
+}
+
+// Compares the two key matchers on the example configurations.  The full
+// Configuration::Parser is not built on the host, because it needs the
+// pin and UART drivers, so this does NOT measure configuration parse
+// times.  It times the real Tokenizer followed by the item matching that
+// ParserHandler does, with the item names of each section taken from the
+// example configurations themselves.
+TEST(ConfigKey, Benchmark) {
+    auto configs = example_configs();
+    if (configs.empty()) {
+        GTEST_SKIP() << "example_configs not found";
+    }
+    std::map<std::string, std::vector<std::string>> names;
+    for (const auto& yaml : configs) {
+        walk(yaml, names, nullptr);
+    }
+    const int passes = 200;
+
+    // Calls go through a volatile pointer so neither matcher is inlined
+    auto time = [&](Matcher const volatile matcher, size_t& compares) {
+        compares   = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            for (const auto& yaml : configs) {
+                compares += walk(yaml, names, matcher);
+            }
+        }
+        std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count() / passes;
+    };
+    size_t legacy_compares, fast_compares;
+    double legacy = time(legacy_is, legacy_compares);
+    double fast   = time([](std::string_view key, const char* expected) { return equal_ignore_case(key, expected); }, fast_compares);
+    EXPECT_EQ(legacy_compares, fast_compares);
+    std::cout << configs.size() << " configs, " << legacy_compares / passes << " compares - tokenize and match with strncasecmp: "
+              << static_cast<long>(legacy) << " us, with equal_ignore_case: " << static_cast<long>(fast)
+              << " us (not a full Parser run)" << std::endl;
+}
@@ -0,0 +1,154 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/GCodeLexer.h"
+
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::vector<std::string> comments;
+static int                      percents;
+
+static void on_comment(char* text) {
+    comments.push_back(text);
+}
+static void on_percent() {
+    ++percents;
+}
+
+static GCodeLexer lexer(on_comment, on_percent);
+
+static std::string lex(const char* text, size_t start = 0, bool skipping = false) {
+    static char line[256];
+    strcpy(line, text);
+    comments.clear();
+    percents = 0;
+    lexer.lex(line, start, skipping);
+    return line;
+}
+
+static float decimal(const char* text) {
+    size_t pos = 0;
+    float  value;
+    EXPECT_TRUE(read_decimal(text, pos, value)) << text;
+    return value;
+}
+
+TEST(GCodeLexer, CollapsesLine) {
+    ASSERT_EQ(lex("g1 x 1.5\ty-2 (Comment) f100\r"), "G1X1.5Y-2F100");
+    ASSERT_EQ(comments.size(), 1);
+    ASSERT_EQ(comments[0], "Comment");
+
+    ASSERT_EQ(lex("G0 X1 (unterminated"), "G0X1");
+    ASSERT_EQ(comments.size(), 1);
+    ASSERT_EQ(comments[0], "unterminated");
+
+    ASSERT_EQ(lex("G0 X1 ; to end of line (not a comment)"), "G0X1");
+    ASSERT_EQ(comments.size(), 0);
+
+    ASSERT_EQ(lex("%"), "");
+    ASSERT_EQ(percents, 1);
+
+    ASSERT_EQ(lex("(skipped) G0 X1", 0, true), "");
+    ASSERT_EQ(lexer.count(), 0);
+    ASSERT_EQ(comments.size(), 0);
+}
+
+TEST(GCodeLexer, ExtractsWords) {
+    lex("G1 X1.5 Y-2 Z+.25 F100");
+    ASSERT_EQ(lexer.count(), 5);
+    ASSERT_EQ(lexer.word(0).letter, 'G');
+    ASSERT_EQ(lexer.word(0).value, 1.0f);
+    ASSERT_EQ(lexer.word(1).letter, 'X');
+    ASSERT_EQ(lexer.word(1).value, decimal("1.5"));
+    ASSERT_EQ(lexer.word(2).value, decimal("-2"));
+    ASSERT_EQ(lexer.word(3).value, decimal("+.25"));
+    ASSERT_EQ(lexer.word(4).letter, 'F');
+    ASSERT_EQ(lexer.rest(), strlen("G1X1.5Y-2Z+.25F100"));
+}
+
+TEST(GCodeLexer, StopsAtGeneralNumbers) {
+    // Parameters and expressions are left for read_number()
+    lex("G1 X#<x> Y2");
+    ASSERT_EQ(lexer.count(), 1);
+    ASSERT_EQ(lexer.rest(), 2);
+
+    lex("G1 X1 #1=2");
+    ASSERT_EQ(lexer.count(), 2);
+    ASSERT_EQ(lexer.rest(), 4);
+
+    lex("G1 X[1+2]");
+    ASSERT_EQ(lexer.count(), 1);
+    ASSERT_EQ(lexer.rest(), 2);
+
+    // Malformed words are too, so they produce the same errors as before
+    lex("G1 X-- Y1");
+    ASSERT_EQ(lexer.count(), 1);
+    ASSERT_EQ(lexer.rest(), 2);
+
+    lex("G1 X1.2.3");
+    ASSERT_EQ(lexer.count(), 2);
+    ASSERT_EQ(lexer.rest(), 6);
+
+    lex("G1 X");
+    ASSERT_EQ(lexer.count(), 1);
+    ASSERT_EQ(lexer.rest(), 2);
+}
+
+TEST(GCodeLexer, StopsAfterOWord) {
+    ASSERT_EQ(lex("o100 while [#1 lt 3]"), "O100WHILE[#1LT3]");
+    ASSERT_EQ(lexer.count(), 1);
+    ASSERT_EQ(lexer.word(0).letter, 'O');
+    ASSERT_EQ(lexer.word(0).value, 100.0f);
+    ASSERT_EQ(lexer.rest(), 4);
+}
+
+TEST(GCodeLexer, StartsAfterJogPrefix) {
+    ASSERT_EQ(lex("$J=g91 x10 f1000", 3), "$J=G91X10F1000");
+    ASSERT_EQ(lexer.count(), 3);
+    ASSERT_EQ(lexer.word(0).letter, 'G');
+    ASSERT_EQ(lexer.word(0).value, 91.0f);
+}
+
+TEST(GCodeLexer, MatchesReadDecimal) {
+    const char* numbers[] = { "0", "1", "-1", "0.0001", "123.4567", "-99999.999", "123456789", "0.123456789", "1.", ".5", "007" };
+    for (auto number : numbers) {
+        std::string line = std::string("X") + number;
+        lex(line.c_str());
+        ASSERT_EQ(lexer.count(), 1) << number;
+        ASSERT_EQ(lexer.word(0).value, decimal(number)) << number;
+    }
+}
+
+// Typical CAM output, lexed repeatedly to report the throughput
+TEST(GCodeLexer, Benchmark) {
+    const char* lines[] = {
+        "G1 X12.3456 Y-7.8901 F1200",
+        "G1 X12.4012 Y-7.9312",
+        "G1 X12.4589 Y-7.9701 Z-0.5000",
+        "G2 X13.0000 Y-8.5000 I0.5411 J-0.5299",
+        "G0 Z5.0000",
+        "N1234 G1 X100.125 Y200.250 Z-1.500 F800.0",
+        "G1 X-45.0001 Y17.2500 (finishing pass)",
+        "M3 S18000",
+    };
+    const int n_lines = sizeof(lines) / sizeof(lines[0]);
+    const int passes  = 100000;
+
+    char buffers[n_lines][64];
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (int i = 0; i < n_lines; ++i) {
+            strcpy(buffers[i], lines[i]);
+            lexer.lex(buffers[i], 0, false);
+        }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    double lines_per_sec = passes * n_lines / elapsed.count();
+    std::cout << "GCodeLexer: " << static_cast<long>(lines_per_sec) << " lines/sec" << std::endl;
+    ASSERT_GT(lines_per_sec, 0);
+}
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/JobAnalyzer.h"
+
+static JobAnalyzer::Limits limits() {
+    JobAnalyzer::Limits l = {};
+    l.n_axis              = 3;
+    for (size_t axis = 0; axis < l.n_axis; axis++) {
+        l.max_rate[axis]     = 6000;  // 100 mm/sec
+        l.acceleration[axis] = 100;
+        l.min_position[axis] = -100;
+        l.max_position[axis] = 0;
+        l.soft_limits[axis]  = true;
+    }
+    l.junction_deviation = 0.01f;
+    l.planner_blocks     = 16;
+    return l;
+}
+
+static const float origin[] = { 0, 0, 0 };
+
+TEST(JobAnalyzer, Trapezoid) {
+    JobAnalyzer analyzer(limits(), origin);
+    float       target[] = { 100, 0, 0 };
+    // 0.1 sec to reach 10 mm/sec and 0.1 sec to stop, covering 1 mm
+    analyzer.move(target, 600, false, false);
+    analyzer.finish();
+    EXPECT_NEAR(analyzer.seconds(), 10.1f, 0.001f);
+    EXPECT_EQ(analyzer.moves(), 1);
+    EXPECT_EQ(analyzer.accel_limited(), 0);
+}
+
+TEST(JobAnalyzer, Triangle) {
+    JobAnalyzer analyzer(limits(), origin);
+    float       target[] = { 1, 0, 0 };
+    // Too short for 100 mm/sec - peaks at 10 mm/sec halfway
+    analyzer.move(target, 6000, false, false);
+    analyzer.finish();
+    EXPECT_NEAR(analyzer.seconds(), 0.2f, 0.001f);
+    EXPECT_EQ(analyzer.accel_limited(), 1);
+}
+
+TEST(JobAnalyzer, StraightJunctions) {
+    JobAnalyzer analyzer(limits(), origin);
+    // Collinear moves, more than the window holds, take as long as one long move
+    for (int i = 1; i <= 40; i++) {
+        float target[] = { 2.5f * i, 0, 0 };
+        analyzer.move(target, 600, false, false);
+    }
+    analyzer.finish();
+    EXPECT_NEAR(analyzer.seconds(), 10.1f, 0.01f);
+    EXPECT_EQ(analyzer.moves(), 40);
+}
+
+TEST(JobAnalyzer, Corners) {
+    JobAnalyzer analyzer(limits(), origin);
+    // A right angle corner slows down, but does not stop
+    float corner[] = { 10, 0, 0 };
+    float end[]    = { 10, 10, 0 };
+    analyzer.move(corner, 600, false, false);
+    analyzer.move(end, 600, false, false);
+    analyzer.finish();
+    EXPECT_GT(analyzer.seconds(), 2.0f);
+    EXPECT_LT(analyzer.seconds(), 2.2f);
+}
+
+TEST(JobAnalyzer, RateLimits) {
+    JobAnalyzer analyzer(limits(), origin);
+    float       target[] = { 100, 0, 0 };
+    analyzer.move(target, 12000, false, false);
+    EXPECT_EQ(analyzer.rate_limited(), 1);
+
+    // Rapids always run at the axis limit
+    float back[] = { 0, 0, 0 };
+    analyzer.move(back, 0, true, false);
+    EXPECT_EQ(analyzer.rate_limited(), 1);
+    analyzer.finish();
+    // Each is 1 sec at 100 mm/sec, plus 1 sec of ramps
+    EXPECT_NEAR(analyzer.seconds(), 4.0f, 0.001f);
+}
+
+TEST(JobAnalyzer, Dwell) {
+    JobAnalyzer analyzer(limits(), origin);
+    float       target[] = { 100, 0, 0 };
+    analyzer.move(target, 600, false, false);
+    analyzer.dwell(2.5f);
+    EXPECT_NEAR(analyzer.seconds(), 12.6f, 0.001f);
+}
+
+TEST(JobAnalyzer, BoundsAndSoftLimits) {
+    JobAnalyzer analyzer(limits(), origin);
+    float       inside[]  = { -10, -20, -5 };
+    float       outside[] = { 5, -20, -5 };
+    analyzer.check(inside, 3);
+    EXPECT_EQ(analyzer.violations(), 0);
+    analyzer.check(outside, 7);
+    analyzer.check(outside, 9);
+    EXPECT_EQ(analyzer.violations(), 2);
+    EXPECT_EQ(analyzer.first_violation_line(), 7);
+
+    float min[3], max[3];
+    ASSERT_TRUE(analyzer.bounds(min, max));
+    EXPECT_EQ(min[0], -10);
+    EXPECT_EQ(max[0], 5);
+    EXPECT_EQ(min[1], -20);
+    EXPECT_EQ(max[1], -20);
+}
@@ -0,0 +1,55 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/LogRing.h"
+
+#include <string>
+#include <vector>
+
+// Writes text a byte at a time, as the startup log channel receives it
+static void write(LogRing& ring, const std::string& text) {
+    for (char c : text) {
+        ring.put(c);
+    }
+}
+
+static std::vector<std::string> lines(const LogRing& ring) {
+    std::vector<std::string> result;
+    ring.lines([&](std::string& line) { result.push_back(line); });
+    return result;
+}
+
+TEST(LogRing, CapturesLogLines) {
+    char    buf[100];
+    size_t  len = 0;
+    LogRing ring(buf, sizeof(buf), len);
+
+    write(ring, "[MSG:INFO: FluidNC v3.9]\r\n");
+    write(ring, "[MSG:INFO: Axis count 3]\n");
+    EXPECT_EQ(lines(ring), (std::vector<std::string> { "[MSG:INFO: FluidNC v3.9]", "[MSG:INFO: Axis count 3]" }));
+
+    ring.append("[MSG:WARN: Restarted after panic reset]\n");
+    EXPECT_EQ(lines(ring).size(), 3u);
+    EXPECT_EQ(lines(ring).back(), "[MSG:WARN: Restarted after panic reset]");
+}
+
+TEST(LogRing, Wraps) {
+    char    buf[40];
+    size_t  len = 0;
+    LogRing ring(buf, sizeof(buf), len);
+
+    for (int i = 0; i < 10; ++i) {
+        write(ring, "[MSG:INFO: line " + std::to_string(i) + "]\n");
+    }
+    EXPECT_EQ(len, 190u);
+    // The newest lines that fit completely, oldest first
+    EXPECT_EQ(lines(ring), (std::vector<std::string> { "[MSG:INFO: line 8]", "[MSG:INFO: line 9]" }));
+}
+
+TEST(LogRing, Empty) {
+    char    buf[10];
+    size_t  len = 0;
+    LogRing ring(buf, sizeof(buf), len);
+    EXPECT_TRUE(lines(ring).empty());
+}
@@ -0,0 +1,101 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Lzss.h"
+
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+
+static std::string compress(const std::string& text, size_t chunk) {
+    std::string out;
+    LzssEncoder encoder([&](const uint8_t* data, size_t length) { out.append(reinterpret_cast<const char*>(data), length); });
+    for (size_t i = 0; i < text.size(); i += chunk) {
+        encoder.write(reinterpret_cast<const uint8_t*>(text.data() + i), std::min(chunk, text.size() - i));
+    }
+    encoder.finish();
+    return out;
+}
+
+static bool decompress(const std::string& data, size_t chunk, std::string& out) {
+    LzssDecoder decoder([&](const uint8_t* data, size_t length) { out.append(reinterpret_cast<const char*>(data), length); });
+    for (size_t i = 0; i < data.size(); i += chunk) {
+        if (!decoder.write(reinterpret_cast<const uint8_t*>(data.data() + i), std::min(chunk, data.size() - i))) {
+            return false;
+        }
+    }
+    return decoder.finish();
+}
+
+static void expect_round_trip(const std::string& text) {
+    for (size_t chunk : { size_t(1), size_t(7), size_t(1000), size_t(100000) }) {
+        std::string compressed = compress(text, chunk);
+        std::string out;
+        ASSERT_TRUE(decompress(compressed, chunk, out));
+        ASSERT_EQ(out, text) << "chunk " << chunk;
+    }
+}
+
+// The example config, or a stand-in if it cannot be found
+static std::string example_config() {
+    std::string   dir = __FILE__;
+    std::ifstream file(dir.substr(0, dir.rfind('/')) + "/../../example_configs/4x_2209_atc.yaml");
+    if (file) {
+        std::stringstream s;
+        s << file.rdbuf();
+        return s.str();
+    }
+    std::string text;
+    for (int i = 0; i < 200; ++i) {
+        text += "axes:\n  x:\n    steps_per_mm: " + std::to_string(80 + i) + "\n    max_rate_mm_per_min: 5000\n";
+    }
+    return text;
+}
+
+TEST(Lzss, Empty) {
+    EXPECT_EQ(compress("", 1), "");
+    expect_round_trip("");
+}
+
+TEST(Lzss, Short) {
+    expect_round_trip("a");
+    expect_round_trip("ab");
+    expect_round_trip("abcabcabcabc");
+    expect_round_trip(std::string(100, 'z'));
+}
+
+TEST(Lzss, Text) {
+    std::string text       = example_config();
+    std::string compressed = compress(text, 512);
+    expect_round_trip(text);
+    EXPECT_LT(compressed.size(), text.size() * 6 / 10);
+    std::cout << text.size() << " bytes of YAML compress to " << compressed.size() << std::endl;
+}
+
+// Data longer than the window, so matches reach the window limit and the
+// encoder slides its buffer
+TEST(Lzss, Long) {
+    std::string text;
+    while (text.size() < 100000) {
+        text += example_config();
+    }
+    expect_round_trip(text);
+
+    std::mt19937 rng(12345);
+    std::string  random;
+    for (int i = 0; i < 20000; ++i) {
+        random += char(rng() % 4 ? 'a' + rng() % 4 : rng());
+    }
+    expect_round_trip(random);
+}
+
+TEST(Lzss, Corrupt) {
+    std::string out;
+    // A match before the start of the data
+    EXPECT_FALSE(decompress(std::string("\x00\x05\x00", 3), 1, out));
+    // Data that ends inside a match
+    out.clear();
+    EXPECT_FALSE(decompress(std::string("\x01" "a" "\x00", 3), 3, out));
+}
@@ -0,0 +1,207 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/GCodeLexer.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+
+static uint32_t float_bits(float f) {
+    uint32_t bits;
+    memcpy(&bits, &f, sizeof(bits));
+    return bits;
+}
+
+static void expect_exact(const std::string& number) {
+    size_t pos = 0;
+    float  value;
+    ASSERT_TRUE(read_decimal(number.c_str(), pos, value)) << number;
+    ASSERT_EQ(pos, number.length()) << number;
+    ASSERT_EQ(float_bits(value), float_bits(strtof(number.c_str(), nullptr))) << number;
+}
+
+TEST(ReadDecimal, Basics) {
+    const char* numbers[] = {
+        "0",
+        "-0",
+        "+1",
+        ".5",
+        "1.",
+        "007",
+        "123.4567",
+        "-99.9999",
+        "0.0001",
+        "0.1",
+        "0.3",
+        "2.675",
+        "16777217",                       // Not exact in float
+        "123456789",                      // 9 digits
+        "1234567890123",                  // Exact in double
+        "9007199254740993",               // Not exact in double
+        "0.000000000000000000001",        // Beyond the exact powers of ten
+        "12345678901234567890123456789",  // More digits than fit in 64 bits
+    };
+    for (auto number : numbers) {
+        expect_exact(number);
+    }
+}
+
+// The reciprocal multiply that replaces the division by a power of ten,
+// over every scale it handles, against strtof().  Mantissas of up to 24
+// bits, which is up to 7 digits, never need the slow path.
+TEST(ReadDecimal, Reciprocals) {
+    std::mt19937 rng(54321);
+    int          fallbacks = 0;
+    for (int k = 1; k <= 9; ++k) {
+        for (uint32_t i = 0; i < 300000; ++i) {
+            uint32_t m = i < 100000 ? i : i < 200000 ? rng() & 0xffffff : rng();
+            float    value;
+            if (!DecimalDigits::convert(m, -k, value)) {
+                fallbacks += m <= 0xffffff;
+                continue;
+            }
+            std::string digits = std::to_string(m);
+            std::string number = digits.length() > size_t(k) ? digits.insert(digits.length() - k, ".")
+                                                             : "0." + std::string(k - digits.length(), '0') + digits;
+            ASSERT_EQ(float_bits(value), float_bits(strtof(number.c_str(), nullptr))) << number;
+        }
+    }
+    EXPECT_EQ(fallbacks, 0);
+}
+
+TEST(ReadDecimal, StopsAtNonDigits) {
+    size_t pos = 0;
+    float  value;
+    ASSERT_TRUE(read_decimal("1.5E3", pos, value));
+    ASSERT_EQ(pos, 3);
+    ASSERT_EQ(value, 1.5f);
+
+    pos = 0;
+    ASSERT_TRUE(read_decimal("1.2.3", pos, value));
+    ASSERT_EQ(pos, 3);
+
+    pos = 0;
+    ASSERT_FALSE(read_decimal("-.", pos, value));
+    ASSERT_FALSE(read_decimal("X", pos, value));
+}
+
+// Random numbers in the formats that CAM programs produce, and some that
+// they do not, must all convert exactly as strtof() does.
+TEST(ReadDecimal, Fuzz) {
+    std::mt19937                    rng(12345);
+    std::uniform_int_distribution<> digit('0', '9');
+    std::uniform_int_distribution<> length(1, 24);
+
+    for (int i = 0; i < 1000000; ++i) {
+        std::string number;
+        switch (rng() % 3) {
+            case 0:
+                number += '-';
+                break;
+            case 1:
+                number += '+';
+                break;
+        }
+        int int_digits  = rng() % 2 ? rng() % 6 : length(rng);
+        int frac_digits = rng() % 2 ? rng() % 5 : length(rng);
+        for (int d = 0; d < int_digits; ++d) {
+            number += char(digit(rng));
+        }
+        if (frac_digits || !int_digits) {
+            number += '.';
+            for (int d = 0; d < frac_digits || d == 0; ++d) {
+                number += char(digit(rng));
+            }
+        }
+        expect_exact(number);
+    }
+}
+
+// The previous read_float(), which accumulated at most 8 digits and
+// applied the exponent by repeated multiplication
+static bool legacy_read_float(const char* line, size_t& pos, float& result) {
+    const char* ptr        = line + pos;
+    char        c          = *ptr;
+    bool        isnegative = false;
+    if (c == '-') {
+        ++ptr;
+        isnegative = true;
+    } else if (c == '+') {
+        ++ptr;
+    }
+    uint32_t intval    = 0;
+    int8_t   exp       = 0;
+    size_t   ndigit    = 0;
+    bool     isdecimal = false;
+    while (1) {
+        c = *ptr;
+        if (isdigit(c)) {
+            ++ptr;
+            ndigit++;
+            if (ndigit <= 8) {
+                if (isdecimal) {
+                    exp--;
+                }
+                intval = intval * 10 + c - '0';
+            } else if (!isdecimal) {
+                exp++;
+            }
+        } else if (c == '.' && !isdecimal) {
+            ++ptr;
+            isdecimal = true;
+        } else {
+            break;
+        }
+    }
+    if (!ndigit) {
+        return false;
+    }
+    float fval = (float)intval;
+    if (fval != 0) {
+        while (exp <= -2) {
+            fval *= 0.01f;
+            exp += 2;
+        }
+        if (exp < 0) {
+            fval *= 0.1f;
+        } else if (exp > 0) {
+            do {
+                fval *= 10.0;
+            } while (--exp > 0);
+        }
+    }
+    result = isnegative ? -fval : fval;
+    pos    = ptr - line;
+    return true;
+}
+
+TEST(ReadDecimal, Benchmark) {
+    const char* numbers[] = { "12.3456", "-7.8901", "1200", "0.5000", "100.125", "-45.0001", "18000", "-0.0625" };
+    const int   n_numbers = sizeof(numbers) / sizeof(numbers[0]);
+    const int   passes    = 1000000;
+
+    // Calls go through a volatile pointer so neither reader is inlined
+    auto time = [&](bool (*const volatile reader)(const char*, size_t&, float&)) {
+        float sum   = 0;
+        auto  start = std::chrono::steady_clock::now();
+        for (int pass = 0; pass < passes; ++pass) {
+            for (int i = 0; i < n_numbers; ++i) {
+                size_t pos = 0;
+                float  value;
+                reader(numbers[i], pos, value);
+                sum += value;
+            }
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        EXPECT_NE(sum, 0.0f);
+        return passes * n_numbers / elapsed.count();
+    };
+    double legacy = time(legacy_read_float);
+    double exact  = time(read_decimal);
+    std::cout << "read_float: " << static_cast<long>(legacy) << " numbers/sec, read_decimal: " << static_cast<long>(exact)
+              << " numbers/sec" << std::endl;
+}
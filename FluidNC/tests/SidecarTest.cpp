@@ -0,0 +1,129 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Sidecar.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+// A sidecar file in memory, with the FileStream methods that SidecarReader uses
+struct MemoryFile {
+    std::vector<uint8_t> data;
+    size_t               pos = 0;
+
+    size_t write(const uint8_t* buf, size_t len) {
+        data.insert(data.begin() + pos, buf, buf + len);
+        pos += len;
+        return len;
+    }
+    size_t read(uint8_t* buf, size_t len) {
+        len = std::min(len, data.size() - pos);
+        std::copy(data.begin() + pos, data.begin() + pos + len, buf);
+        pos += len;
+        return len;
+    }
+    size_t size() { return data.size(); }
+    size_t position() { return pos; }
+    void   set_position(size_t p) { pos = p; }
+};
+
+// Writes a sidecar for lines, numbering them from 1 and leaving out blank ones
+static MemoryFile make_sidecar(const std::vector<std::string>& lines) {
+    MemoryFile    file;
+    SidecarHeader header = {};
+    memcpy(header.magic, sidecar_magic, sizeof(header.magic));
+    header.version = sidecar_version;
+    header.records = lines.size();
+    file.write((uint8_t*)&header, sizeof(header));
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (!lines[i].empty()) {
+            write_sidecar_record(file, i + 1, lines[i].c_str());
+        }
+    }
+    file.set_position(sizeof(header));
+    return file;
+}
+
+TEST(Sidecar, ReadsRecords) {
+    auto                      file = make_sidecar({ "", "G0X1", "G1Y2F100" });
+    SidecarReader<MemoryFile> reader(file);
+    char                      line[100];
+    uint32_t                  line_number;
+
+    EXPECT_EQ(reader.position(), 0);
+    ASSERT_EQ(reader.read(line, sizeof(line), line_number), Error::Ok);
+    EXPECT_STREQ(line, "G0X1");
+    EXPECT_EQ(line_number, 2);
+    ASSERT_EQ(reader.read(line, sizeof(line), line_number), Error::Ok);
+    EXPECT_STREQ(line, "G1Y2F100");
+    EXPECT_EQ(line_number, 3);
+    EXPECT_EQ(reader.position(), reader.size());
+    EXPECT_EQ(reader.read(line, sizeof(line), line_number), Error::Eof);
+}
+
+TEST(Sidecar, LineTooLong) {
+    auto                      file = make_sidecar({ "G0X1234567" });
+    SidecarReader<MemoryFile> reader(file);
+    char                      line[100];
+    uint32_t                  line_number;
+
+    EXPECT_EQ(reader.read(line, 5, line_number), Error::FsFailedRead);
+}
+
+// Follows JobSource::call_subroutine() for a CALL whose SUB comes later in
+// the file: rewind to 0, scan for definitions, jump to the body, and go
+// back to the line after the CALL.
+TEST(Sidecar, ForwardCall) {
+    auto                      file = make_sidecar({ "G21", "O100CALL", "G0X0", "M2", "", "O100SUB", "G1X10F500", "O100ENDSUB" });
+    SidecarReader<MemoryFile> reader(file);
+    char                      line[100];
+    uint32_t                  line_number;
+
+    ASSERT_EQ(reader.read(line, sizeof(line), line_number), Error::Ok);
+    ASSERT_EQ(reader.read(line, sizeof(line), line_number), Error::Ok);
+    ASSERT_STREQ(line, "O100CALL");
+    size_t resume = reader.position();
+
+    std::map<std::string, std::pair<size_t, uint32_t>> subroutines;
+    reader.set_position(0);
+    size_t last = 0;
+    while (reader.read(line, sizeof(line), line_number) == Error::Ok) {
+        size_t pos = reader.position();
+        ASSERT_GT(pos, last);
+        last = pos;
+        if (std::string(line).find("SUB") != std::string::npos && std::string(line).find("END") == std::string::npos) {
+            subroutines[line] = { pos, line_number };
+        }
+    }
+    ASSERT_EQ(subroutines.count("O100SUB"), 1);
+    EXPECT_EQ(subroutines["O100SUB"].second, 6);
+
+    reader.set_position(subroutines["O100SUB"].first);
+    ASSERT_EQ(reader.read(line, sizeof(line), line_number), Error::Ok);
+    EXPECT_STREQ(line, "G1X10F500");
+    EXPECT_EQ(line_number, 7);
+    ASSERT_EQ(reader.read(line, sizeof(line), line_number), Error::Ok);
+    EXPECT_STREQ(line, "O100ENDSUB");
+
+    reader.set_position(resume);
+    ASSERT_EQ(reader.read(line, sizeof(line), line_number), Error::Ok);
+    EXPECT_STREQ(line, "G0X0");
+    EXPECT_EQ(line_number, 3);
+}
+
+// The first line of the program is found again after a rewind
+TEST(Sidecar, Rewind) {
+    auto                      file = make_sidecar({ "", "", "G90", "G0X1" });
+    SidecarReader<MemoryFile> reader(file);
+    char                      line[100];
+    uint32_t                  line_number;
+
+    while (reader.read(line, sizeof(line), line_number) == Error::Ok) {}
+    reader.set_position(0);
+    ASSERT_EQ(reader.read(line, sizeof(line), line_number), Error::Ok);
+    EXPECT_STREQ(line, "G90");
+    EXPECT_EQ(line_number, 3);
+}
@@ -0,0 +1,103 @@
+// Copyright (c) 2024 -  FluidNC developers
+// Use of this source code is governed by a GPLv3 license that can be found in the LICENSE file.
+
+#include "gtest/gtest.h"
+#include "src/Configuration/Tokenizer.h"
+#include "src/Configuration/ParseException.h"
+
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace Configuration;
+
+struct Token {
+    int         linenum;
+    int         indent;
+    std::string key;
+    std::string value;
+
+    bool operator==(const Token& o) const { return linenum == o.linenum && indent == o.indent && key == o.key && value == o.value; }
+};
+
+static std::ostream& operator<<(std::ostream& os, const Token& t) {
+    return os << t.linenum << ":" << t.indent << " " << t.key << ": " << t.value;
+}
+
+// The tokens that the parser sees, as it calls Tokenize() until Eof
+static std::vector<Token> tokens(std::string_view input, bool snapshot) {
+    std::vector<Token> result;
+    Tokenizer          tokenizer(input, snapshot);
+    for (tokenizer.Tokenize(); tokenizer._token._state != TokenState::Eof; tokenizer.Tokenize()) {
+        auto& token = tokenizer._token;
+        result.push_back({ tokenizer._linenum, token._indent, std::string(token._key), std::string(token._value) });
+    }
+    return result;
+}
+
+static void expect_round_trip(const std::string& yaml) {
+    std::string records;
+    ASSERT_TRUE(Tokenizer::encode(yaml, records));
+    auto parsed   = tokens(yaml, false);
+    auto replayed = tokens(records, true);
+    ASSERT_EQ(parsed.size(), replayed.size());
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        EXPECT_EQ(parsed[i], replayed[i]) << "token " << i;
+    }
+}
+
+TEST(Tokenizer, Simple) {
+    std::string yaml = "name: Test\nboard: \"None\"\n\naxes:\n  # comment\n  x:\n    steps_per_mm: 80\n    empty:\n";
+    auto        t    = tokens(yaml, false);
+    ASSERT_EQ(t.size(), 6);
+    EXPECT_EQ(t[1], (Token { 2, 0, "board", "None" }));
+    EXPECT_EQ(t[4], (Token { 7, 4, "steps_per_mm", "80" }));
+    EXPECT_EQ(t[5], (Token { 8, 4, "empty", "" }));
+    expect_round_trip(yaml);
+}
+
+TEST(Tokenizer, CarriageReturns) {
+    expect_round_trip("axes:\r\n  x:\r\n    steps_per_mm: 80\r\n  \r\n");
+}
+
+TEST(Tokenizer, Empty) {
+    std::string records;
+    ASSERT_TRUE(Tokenizer::encode("", records));
+    EXPECT_TRUE(records.empty());
+    EXPECT_TRUE(tokens(records, true).empty());
+}
+
+TEST(Tokenizer, Truncated) {
+    std::string records;
+    ASSERT_TRUE(Tokenizer::encode("name: Test\n", records));
+    records.pop_back();
+    EXPECT_THROW(tokens(records, true), ParseException);
+}
+
+TEST(Tokenizer, ValueTooLong) {
+    std::string records;
+    EXPECT_FALSE(Tokenizer::encode("name: " + std::string(70000, 'x') + "\n", records));
+}
+
+// Every example configuration produces the same tokens from its snapshot
+// records as from its YAML text
+TEST(Tokenizer, ExampleConfigs) {
+    std::string dir = __FILE__;
+    dir             = dir.substr(0, dir.rfind('/')) + "/../../example_configs/";
+    int found       = 0;
+    for (auto name : { "4x_2209_atc.yaml", "4x_2209_atc_class.yaml", "4x_2209a_atc_class.yaml", "uartio.yaml" }) {
+        std::ifstream file(dir + name);
+        if (!file) {
+            continue;
+        }
+        std::stringstream s;
+        s << file.rdbuf();
+        SCOPED_TRACE(name);
+        expect_round_trip(s.str());
+        ++found;
+    }
+    if (!found) {
+        GTEST_SKIP() << "example_configs not found";
+    }
+}